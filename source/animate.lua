@@ -0,0 +1,145 @@
+#!/usr/local/bin/luapp
+
+local chronos = require"chronos"
+local total = chronos.chronos()
+
+local quiet = false
+
+local function stderr(...)
+    if not quiet then
+        io.stderr:write(string.format(...))
+    end
+end
+
+-- print help and exit
+local function help()
+    io.stderr:write([=[
+Usage:
+  lua animate.lua [options] <driver> <input.rvg> <output>
+where options are:
+  -sweep:<x0>:<y0>:<x1>:<y1>:<n>  append <n> frames translating from (x0,y0) to (x1,y1)
+  -zoom:<s0>:<s1>:<n>             append <n> frames scaling by s0 to s1 about the viewport center
+<output> is either a pattern for numbered png files with a single %d or
+%0Nd (out-%05d.png)
+or a file receiving a raw rgb24 stream ("-" for stdout)
+]=])
+    os.exit()
+end
+
+local drivername, inputname, outputname
+-- translation and scale of each frame
+local frames = {}
+
+local number = "(%-?[%d%.]+)"
+local options = {
+    { "^%-help$", function(w)
+        if w then
+            help()
+            return true
+        else
+            return false
+        end
+    end },
+    { "^%-quiet$", function(d)
+        if not d then return false end
+        quiet = true;
+        return true
+    end },
+    { "^(%-sweep%:" .. number .. "%:" .. number .. "%:" .. number .. "%:" ..
+        number .. "%:(%d+)(.*))$", function(all, x0, y0, x1, y1, n, e)
+        if not n then return false end
+        assert(e == "", "invalid option " .. all)
+        x0, y0 = assert(tonumber(x0)), assert(tonumber(y0))
+        x1, y1 = assert(tonumber(x1)), assert(tonumber(y1))
+        n = math.floor(assert(tonumber(n), "invalid option " .. all))
+        assert(n >= 1, "invalid option " .. all)
+        for i = 0, n-1 do
+            local t = n > 1 and i/(n-1) or 0
+            frames[#frames+1] = { x0 + t*(x1-x0), y0 + t*(y1-y0), 1 }
+        end
+        return true
+    end },
+    { "^(%-zoom%:" .. number .. "%:" .. number .. "%:(%d+)(.*))$",
+        function(all, s0, s1, n, e)
+        if not n then return false end
+        assert(e == "", "invalid option " .. all)
+        s0, s1 = assert(tonumber(s0)), assert(tonumber(s1))
+        assert(s0 > 0 and s1 > 0, "invalid option " .. all)
+        n = math.floor(assert(tonumber(n), "invalid option " .. all))
+        assert(n >= 1, "invalid option " .. all)
+        for i = 0, n-1 do
+            local t = n > 1 and i/(n-1) or 0
+            frames[#frames+1] = { 0, 0, s0 + t*(s1-s0) }
+        end
+        return true
+    end },
+}
+
+-- rejected options are passed to driver
+local rejected = {}
+local values = {}
+
+for i, argument in ipairs({...}) do
+    if argument:sub(1,1) == "-" and #argument > 1 then
+        local recognized = false
+        for j, option in ipairs(options) do
+            if option[2](argument:match(option[1])) then
+                recognized = true
+                break
+            end
+        end
+        if not recognized then
+            rejected[#rejected+1] = argument
+        end
+    else
+        values[#values+1] = argument
+    end
+end
+
+drivername = values[1]
+inputname = values[2]
+outputname = values[3]
+
+assert(drivername, "missing <driver> argument")
+assert(inputname, "missing <input.rvg> argument")
+assert(outputname, "missing <output> argument")
+if not package.searchpath(drivername, package.cpath) and
+   not package.searchpath(drivername, package.path) then
+    drivername = "driver." .. drivername
+end
+local driver = require(drivername)
+assert(type(driver) == "table", "invalid driver")
+assert(driver.animate, "driver has no animate function")
+
+-- the scene is loaded once and shared by every frame
+stderr("processing %s\n", inputname)
+local time = chronos.chronos()
+local input
+if _VERSION == "Lua 5.1" then
+    input = assert(setfenv(assert(loadfile(inputname)), driver)())
+else
+    input = assert(assert(loadfile(inputname, "bt", driver))())
+end
+stderr("loaded in %gs\n", time:elapsed())
+
+if #frames == 0 then
+    frames[1] = { 0, 0, 1 }
+end
+-- zoom frames scale about the viewport center
+local cx = (input.viewport[1] + input.viewport[3])/2
+local cy = (input.viewport[2] + input.viewport[4])/2
+local xforms = {}
+for i, f in ipairs(frames) do
+    if f[3] == 1 then
+        xforms[i] = driver.translation(f[1], f[2])
+    else
+        xforms[i] = driver.translation(-cx, -cy):scaled(f[3]):
+            translated(cx+f[1], cy+f[2])
+    end
+end
+
+time:reset()
+driver.animate(input.scene, input.window, input.viewport, xforms,
+    outputname, rejected)
+stderr("animate %d frames in %gs\n", #xforms, time:elapsed())
+stderr("done in %gs\n", total:elapsed())
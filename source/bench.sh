@@ -0,0 +1,28 @@
+#!/bin/bash
+# renders every scene, or those named in $SCENES, into $outputs with
+# the driver options given, repeating accelerate and render, and prints
+# their average seconds per scene followed by the sums
+if [ -n "$SCENES" ]; then
+    inputs=`for scene in $SCENES; do echo ../rvgs/$scene.rvg; done`
+else
+    inputs=`ls ../rvgs/*.rvg`
+fi
+outputs=${OUTPUTS:-"../pngs-bench/"}
+driver='driver.hadryan_salles'
+program='process.lua'
+lua=${LUA:-'luapp5.3'}
+repeats=${REPEATS:-3}
+
+[ ! -d $outputs ] && mkdir $outputs
+rm -f $outputs*
+for input in $inputs
+do
+    filename=$(basename -- "$input")
+    filename="${filename%.*}"
+    output=$outputs$filename".png"
+    $lua $program $driver $input $output -accel-repeats:$repeats \
+        -render-repeats:$repeats $@ 2>&1 | awk -v name=$filename '
+        /^accelerate in/ { a = $3 }
+        /^render in/ { r = $3 }
+        END { sub("s$", "", a); sub("s$", "", r); print name, a, r }'
+done | awk '{ print; a += $2; r += $3 } END { print "total", a, r }'
@@ -1,9 +1,11 @@
 #!/usr/bin/python3
 import cv2
 import os
+import sys
 
-gtp = "../pngs/"
-outp = "../pngs-out/"
+# compare.py [reference dir] [output dir]
+gtp = sys.argv[1] if len(sys.argv) > 1 else "../pngs/"
+outp = sys.argv[2] if len(sys.argv) > 2 else "../pngs-out/"
 gt = os.listdir(gtp)
 out = os.listdir(outp)
 tdif = 0
@@ -11,8 +13,8 @@ for img in gt :
     if not out.__contains__(img) :
         print("error. missing file", img) 
     else :
-        o = cv2.imread(gtp+img)
-        d = cv2.imread(outp+img)
+        o = cv2.imread(os.path.join(gtp, img))
+        d = cv2.imread(os.path.join(outp, img))
         if o.shape != d.shape : 
             print("error. images with different shapes", img)
         else :    
@@ -1,5 +1,7 @@
 #include "hadryan-accelerated-builder.h"
 
+#include <cstdio>
+
 #include "rvg-input-path-f-close-contours.h"
 #include "rvg-input-path-f-xform.h"
 #include "rvg-input-path-f-downgrade-degenerate.h"
@@ -16,7 +18,7 @@ using namespace rvg;
 namespace hadryan {
 
 void accelerated_builder::unpack_args(const std::vector<std::string> &args) {
-    acc.samples = blue_noise::get_1();
+    acc.set_samples(blue_noise::get_1());
     double tx = 0;
     double ty = 0;
     for (auto &arg : args) {
@@ -25,15 +27,15 @@ void accelerated_builder::unpack_args(const std::vector<std::string> &args) {
         std::string value = arg.substr(arg.find(delimiter)+1, arg.length()); 
         if(command == std::string{"-pattern"}) {
             if(value == std::string{"1"}) {
-                acc.samples = blue_noise::get_1();
+                acc.set_samples(blue_noise::get_1());
             } else if(value == std::string{"8"}) {
-                acc.samples = blue_noise::get_8();
+                acc.set_samples(blue_noise::get_8());
             } else if(value == std::string{"16"}) {
-                acc.samples = blue_noise::get_16();
+                acc.set_samples(blue_noise::get_16());
             } else if(value == std::string{"32"}) {
-                acc.samples = blue_noise::get_32();
+                acc.set_samples(blue_noise::get_32());
             } else if(value == std::string{"64"}) {
-                acc.samples = blue_noise::get_64();
+                acc.set_samples(blue_noise::get_64());
             }
         } else if(command == std::string{"-tx"}) {
             tx = std::stof(value);
@@ -42,28 +44,151 @@ void accelerated_builder::unpack_args(const std::vector<std::string> &args) {
         } else if(command == std::string{"-j"}) {
             acc.threads = std::stoi(value);
         } else if(command == std::string{"-depth"}) {
-            tree_node::set_max_depth(std::stoi(value));
+            acc.config.max_depth = std::stoi(value);
         } else if(command == std::string{"-min_seg"}) {
-            tree_node::set_min_segments(std::stoi(value));
+            acc.config.min_segments = std::stoi(value);
+        } else if(command == std::string{"-task_depth"}) {
+            acc.config.task_depth = std::stoi(value);
+        } else if(command == std::string{"-task_seg"}) {
+            acc.config.task_segments = std::stoi(value);
+        } else if(command == std::string{"-render"}) {
+            if(value == std::string{"pixels"}) {
+                acc.mode = e_render_mode::pixels;
+            } else if(value == std::string{"leaves"}) {
+                acc.mode = e_render_mode::leaves;
+            }
+        } else if(command == std::string{"-aa"}) {
+            if(value == std::string{"full"}) {
+                acc.aa = e_aa_mode::full;
+            } else if(value == std::string{"adaptive"}) {
+                acc.aa = e_aa_mode::adaptive;
+            } else if(value == std::string{"analytic"}) {
+                acc.aa = e_aa_mode::analytic;
+            }
+        } else if(command == std::string{"-simd"}) {
+            if(value == std::string{"off"}) {
+                acc.simd = e_simd_mode::off;
+            } else if(value == std::string{"scalar"}) {
+                acc.simd = e_simd_mode::scalar;
+            } else if(value == std::string{"avx2"}) {
+                acc.simd = e_simd_mode::avx2;
+            } else if(value == std::string{"avx512"}) {
+                acc.simd = e_simd_mode::avx512;
+            } else if(value == std::string{"auto"}) {
+                acc.simd = e_simd_mode::automatic;
+            }
+        } else if(command == std::string{"-precision"}) {
+            if(value == std::string{"double"}) {
+                acc.precision = e_precision_mode::full;
+            } else if(value == std::string{"float"}) {
+                acc.precision = e_precision_mode::single;
+            }
+        } else if(command == std::string{"-flatten"}) {
+            acc.flatness = std::max(std::stof(value), 0.0f);
+        } else if(command == std::string{"-split"}) {
+            if(value == std::string{"fixed"}) {
+                acc.config.split = e_split_mode::fixed;
+            } else if(value == std::string{"cost"}) {
+                acc.config.split = e_split_mode::cost;
+            }
+        } else if(command == std::string{"-build"}) {
+            if(value == std::string{"eager"}) {
+                acc.config.build = e_build_mode::eager;
+            } else if(value == std::string{"lazy"}) {
+                acc.config.build = e_build_mode::lazy;
+            }
+        } else if(command == std::string{"-accel"}) {
+            if(value == std::string{"tree"}) {
+                acc.config.accel = e_accel_mode::tree;
+            } else if(value == std::string{"grid"}) {
+                acc.config.accel = e_accel_mode::grid;
+            }
+        } else if(command == std::string{"-grid"}) {
+            acc.config.grid_size = std::max(std::stoi(value), 0);
+        } else if(command == std::string{"-tree"}) {
+            if(value == std::string{"pointer"}) {
+                acc.config.layout = e_tree_layout::pointer;
+            } else if(value == std::string{"flat"}) {
+                acc.config.layout = e_tree_layout::flat;
+            }
+        } else if(command == std::string{"-store"}) {
+            if(value == std::string{"objects"}) {
+                acc.config.store = e_store_mode::objects;
+            } else if(value == std::string{"soa"}) {
+                acc.config.store = e_store_mode::soa;
+            }
+        } else if(command == std::string{"-index"}) {
+            acc.block = std::max(std::stoi(value), 0);
+        } else if(command == std::string{"-tile"}) {
+            acc.tile = std::max(std::stoi(value), 1);
+        } else if(command == std::string{"-stats"}) {
+            acc.stats = true;
+        } else if(command == std::string{"-resolve"}) {
+            if(value == std::string{"int"}) {
+                acc.resolve = e_resolve_mode::integer;
+            } else if(value == std::string{"float"}) {
+                acc.resolve = e_resolve_mode::linear;
+            }
         }
     }
     push_xf(translation(tx, ty));
 }
 
+// only the transform stack depends on the scene order, so shapes are
+// recorded with it and converted later by convert()
 void accelerated_builder::do_painted_shape(e_winding_rule wr, const shape &s, const paint &p){
+    m_shapes.push_back(shape_item{wr, s, p, top_xf()});
+}
+
+// curves and lines count the curves flattened and the lines they became
+scene_object* accelerated_builder::convert(const shape_item &item, 
+    int &curves, int &lines) const {
     xform post;
-    monotonic_builder path_builder;
-    path_data::const_ptr path_data = s.as_path_data_ptr(post);
-    const xform s_xf = post*top_xf()*s.get_xf();
+    monotonic_builder path_builder(acc.flatness);
+    path_data::const_ptr path_data = item.s.as_path_data_ptr(post);
+    const xform s_xf = post*item.xf*item.s.get_xf();
     path_data->iterate(make_input_path_f_close_contours(
                         make_input_path_f_xform(s_xf,
                         make_input_path_f_downgrade_degenerate(
                         make_input_path_f_monotonize(
                         make_input_path_not_interger(
                         path_builder))))));
+    curves = path_builder.get_curves();
+    lines = path_builder.get_lines();
     if(path_builder.get().size() > 0) {
-        acc.add(new scene_object(path_builder.get(), wr, p.transformed(top_xf())));
+        return new scene_object(path_builder.get(), item.wr, item.p.transformed(item.xf));
     } 
+    return nullptr;
+}
+
+// converts the recorded shapes in parallel, each into its own slot,
+// and adds them to acc in scene order
+void accelerated_builder::convert() {
+    int n_shapes = m_shapes.size();
+    std::vector<scene_object*> slots(n_shapes, nullptr);
+    long curves = 0;
+    long lines = 0;
+    #pragma omp parallel for schedule(dynamic) num_threads(acc.threads) reduction(+:curves,lines)
+    for(int i = 0; i < n_shapes; i++) {
+        int c = 0;
+        int l = 0;
+        slots[i] = convert(m_shapes[i], c, l);
+        curves += c;
+        lines += l;
+    }
+    long segments = 0;
+    for(auto obj : slots) {
+        if(obj != nullptr) {
+            segments += obj->get_path().size();
+            acc.add(obj);
+        }
+    }
+    m_shapes.clear();
+    if(acc.stats && acc.flatness > 0) {
+        // the render times against a run without -flatten give the gain
+        fprintf(stderr, "flatten %ld curves into %ld lines, segments %ld -> %ld\n",
+            curves, lines, segments - lines + curves, segments);
+    }
 }
 
-} // hadryan
\ No newline at end of file
+} // hadryan
@@ -5,6 +5,8 @@
 #include "rvg-winding-rule.h"
 #include "rvg-patch.h"
 #include "rvg-i-scene-data.h"
+#include "rvg-shape.h"
+#include "rvg-paint.h"
 
 #include "hadryan-accelerated.h"
 
@@ -12,11 +14,21 @@ using namespace rvg;
 
 namespace hadryan {
 
+class scene_object;
+
 class accelerated_builder final: public i_scene_data<accelerated_builder> {
 private:
     friend i_scene_data<accelerated_builder>;
+    // painted shape with the transform stack at its point of the scene
+    struct shape_item {
+        e_winding_rule wr;
+        shape s;
+        paint p;
+        xform xf;
+    };
     accelerated &acc;
     std::vector<xform> m_xf_stack;
+    std::vector<shape_item> m_shapes;
     
     void pop_xf();
     void push_xf(const xform &xf);
@@ -25,6 +37,7 @@ private:
     void do_begin_transform(uint16_t depth, const xform &xf);
     void do_end_transform(uint16_t depth, const xform &xf);
     void do_painted_shape(e_winding_rule wr, const shape &s, const paint &p);
+    scene_object* convert(const shape_item &item, int &curves, int &lines) const;
     
     inline void do_tensor_product_patch(const patch<16,4> &tpp){(void) tpp;};
     inline void do_coons_patch(const patch<12,4> &cp){(void) cp;};
@@ -42,6 +55,7 @@ public:
     inline accelerated_builder(accelerated &acc_in, 
         const std::vector<std::string> &args, const xform &screen_xf);
     void unpack_args(const std::vector<std::string> &args);
+    void convert();
 };
 
 inline accelerated_builder::accelerated_builder(accelerated &acc_in, 
@@ -49,6 +63,7 @@ inline accelerated_builder::accelerated_builder(accelerated &acc_in,
     :   acc(acc_in) {
     unpack_args(args);
     push_xf(screen_xf);
+    acc.xf = top_xf();
 }
 
 inline void accelerated_builder::pop_xf() {
@@ -1,17 +1,177 @@
 #include "hadryan-accelerated.h"
 
+#include <cmath>
+
 #include "hadryan-tree-node.h"
+#include "hadryan-leave-node.h"
+#include "hadryan-flat-tree.h"
+#include "hadryan-block-index.h"
+#include "hadryan-grid.h"
 #include "hadryan-scene-object.h"
 
 namespace hadryan {
 
+accelerated& accelerated::operator=(accelerated &&rhs) {
+    if(this != &rhs) {
+        destroy();
+        objects = std::move(rhs.objects);
+        rhs.objects.clear();
+        source = std::move(rhs.source);
+        xf = rhs.xf;
+        root = rhs.root;
+        rhs.root = nullptr;
+        tree_arena = rhs.tree_arena;
+        rhs.tree_arena = nullptr;
+        flat = rhs.flat;
+        rhs.flat = nullptr;
+        cells = rhs.cells;
+        rhs.cells = nullptr;
+        root_index = rhs.root_index;
+        rhs.root_index = nullptr;
+        flat_index = rhs.flat_index;
+        rhs.flat_index = nullptr;
+        samples = std::move(rhs.samples);
+        footprint = rhs.footprint;
+        threads = rhs.threads;
+        block = rhs.block;
+        tile = rhs.tile;
+        stats = rhs.stats;
+        mode = rhs.mode;
+        aa = rhs.aa;
+        resolve = rhs.resolve;
+        simd = rhs.simd;
+        precision = rhs.precision;
+        flatness = rhs.flatness;
+        config = rhs.config;
+    }
+    return *this;
+}
+
 void accelerated::destroy() { 
-    for(auto &obj : objects) {
-        delete obj;
-        obj = NULL;
+    objects.clear();
+    source.reset();
+    delete root_index;
+    root_index = nullptr;
+    delete flat_index;
+    flat_index = nullptr;
+    // the nodes go with their arena
+    root = nullptr;
+    delete tree_arena;
+    tree_arena = nullptr;
+    delete flat;
+    flat = nullptr;
+    delete cells;
+    cells = nullptr;
+}
+
+// replaces the pointer tree by its flat_tree copy
+void accelerated::flatten() {
+    if(root == nullptr) {
+        return;
+    }
+    flat = new flat_tree(root, config.store == e_store_mode::soa,
+        precision == e_precision_mode::single);
+    root = nullptr;
+    delete tree_arena;
+    tree_arena = nullptr;
+}
+
+// d is the offset from xf0 to xf1 when they differ only by a
+// translation of whole pixels, which keeps the segment end points off
+// the integer grid
+static bool integer_offset(const xform &xf0, const xform &xf1, R2 &d) {
+    for(int i = 0; i < 3; i++) {
+        for(int j = 0; j < 3; j++) {
+            if((i == 2 || j < 2) && xf0[i][j] != xf1[i][j]) {
+                return false;
+            }
+        }
+    }
+    if(xf0[2][0] != 0 || xf0[2][1] != 0 || xf0[2][2] != 1) {
+        return false;
+    }
+    double dx = xf1[0][2] - xf0[0][2];
+    double dy = xf1[1][2] - xf0[1][2];
+    if(std::abs(dx - std::round(dx)) > 1e-3 || std::abs(dy - std::round(dy)) > 1e-3) {
+        return false;
+    }
+    d = make_R2(std::round(dx), std::round(dy));
+    return true;
+}
+
+// d maps the screen space of xf0 to that of xf1 when it is a scale
+// along the axes and a translation, as between viewports of different
+// sizes over the same window, which keeps every segment monotonic
+static bool axis_aligned(const xform &xf0, const xform &xf1, xform &d) {
+    for(auto xf : {&xf0, &xf1}) {
+        if((*xf)[2][0] != 0 || (*xf)[2][1] != 0 || (*xf)[2][2] != 1) {
+            return false;
+        }
+    }
+    xform m = xf1 * xf0.inverse();
+    double sx = m[0][0];
+    double sy = m[1][1];
+    double eps = 1e-9*(std::abs(sx) + std::abs(sy));
+    if(sx == 0 || sy == 0 || std::abs(m[0][1]) > eps || std::abs(m[1][0]) > eps) {
+        return false;
+    }
+    d = make_affinity(sx, 0, m[0][2], 0, sy, m[1][2]);
+    return true;
+}
+
+// d moves every point by the same distance from its curve, as a pan
+// or a flip along the axes does
+static bool unit_scale(const xform &d) {
+    return std::abs(std::abs(d[0][0]) - 1) <= 1e-9 && std::abs(std::abs(d[1][1]) - 1) <= 1e-9;
+}
+
+// takes the objects of prev, when built from the same scene data as
+// source, instead of building them again when xf is a translation of
+// prev.xf by whole pixels, which offsets them exactly, or an
+// axis-aligned scale and translation of it, fractional pans included,
+// which rebuilds their segments from the mapped control points.
+// Flattened curves are only taken panned or flipped, as a scale would
+// scale their error. The objects are shared with prev, which stays valid
+// to render, and copied before they move.
+bool accelerated::take_transformed(accelerated &prev) {
+    return take_transformed(prev, false);
+}
+
+// the same, giving up prev: its tree is released and the objects it
+// held alone are moved in place
+bool accelerated::take_transformed(accelerated &&prev) {
+    return take_transformed(prev, true);
+}
+
+bool accelerated::take_transformed(accelerated &prev, bool release) {
+    R2 t;
+    xform d;
+    bool translated = integer_offset(prev.xf, xf, t);
+    if(prev.objects.empty() || !source || prev.source != source ||
+        prev.flatness != flatness || (!translated && 
+        (!axis_aligned(prev.xf, xf, d) || (flatness > 0 && !unit_scale(d))))) {
+        return false;
+    }
+    objects = prev.objects;
+    if(release) {
+        prev.destroy();
+    }
+    if(translated && t[0] == 0 && t[1] == 0) {
+        return true;
+    }
+    int n_objects = objects.size();
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(threads)
+    for(int i = 0; i < n_objects; i++) {
+        std::shared_ptr<scene_object> &obj = objects[i];
+        if(obj.use_count() > 1) {
+            obj.reset(translated ? obj->translated(t) : obj->transformed(d));
+        } else if(translated) {
+            obj->translate(t);
+        } else {
+            obj->transform(d);
+        }
     }
-    root->destroy();
-    delete root;
+    return true;
 }
 
 } // hadryan
\ No newline at end of file
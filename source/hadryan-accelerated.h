@@ -2,8 +2,17 @@
 #define HADRYAN_ACCELERATED_H
 
 #include <vector>
+#include <memory>
+#include <utility>
 
 #include "rvg-point.h"
+#include "rvg-xform.h"
+#include "rvg-scene-data.h"
+
+#include "hadryan-bouding-box.h"
+#include "hadryan-tree-config.h"
+#include "hadryan-arena.h"
+#include "hadryan-sample-lanes.h"
 
 using namespace rvg;
 
@@ -11,33 +20,119 @@ namespace hadryan {
 
 class scene_object;
 class tree_node;
+class leave_node;
+class flat_tree;
+class flat_leaf;
+class grid;
+template <typename TREE, typename LEAF> class block_index;
+
+enum class e_render_mode {
+    pixels, // descend from the root for each pixel
+    leaves  // walk the leaves and sample every pixel inside each one
+};
+
+enum class e_aa_mode {
+    full,     // every pixel takes all samples of the pattern
+    adaptive, // pixels with constant coverage take a single sample
+    analytic  // exact area of linear segments, samples only where curves cross
+};
+
+enum class e_resolve_mode {
+    integer, // samples averaged in 8-bit linear light
+    linear   // samples averaged in float linear light
+};
 
+// Owns the tree built from the scene objects, which it shares with the
+// accelerated built from it by take_transformed. Both stay valid for
+// any number of renders and are released by the destructor, the
+// objects with their last owner. It can be moved but not copied.
 class accelerated {
+    bool take_transformed(accelerated &prev, bool release);
 public:
-    std::vector<scene_object*> objects;
-    tree_node* root = nullptr;
+    std::vector<std::shared_ptr<scene_object>> objects;
+    // scene data the objects were built from, held so that no other
+    // scene takes its address while objects may be reused
+    scene_data::const_ptr source;
+    xform xf; // screen transform the objects were built with
+    tree_node* root = nullptr; // lives in tree_arena
+    arena* tree_arena = nullptr;
+    flat_tree* flat = nullptr;
+    grid* cells = nullptr; // its cells live in tree_arena
+    // blocks of the viewport mapped to the leaves of root or flat, built
+    // with them when block > 0 for the pixels render mode of an eager tree
+    block_index<tree_node, leave_node>* root_index = nullptr;
+    block_index<flat_tree, flat_leaf>* flat_index = nullptr;
     std::vector<R2> samples;
+    bouding_box footprint; // bounds of the sample offsets
     int threads;
+    int block; // pixels per side of a block_index entry, 0 disables it
+    int tile;  // pixels per side of a render tile
+    bool stats; // report build and render statistics to stderr
+    e_render_mode mode;
+    e_aa_mode aa;
+    e_resolve_mode resolve;
+    e_simd_mode simd; // how the samples of a pixel meet the segments
+    e_precision_mode precision; // of the segment tests in the lanes
+    double flatness; // pixels curves may move when made linear, 0 keeps them
+    tree_config config;
 public:
     accelerated();
+    accelerated(accelerated &&rhs);
+    accelerated& operator=(accelerated &&rhs);
+    accelerated(const accelerated &rhs) = delete;
+    accelerated& operator=(const accelerated &rhs) = delete;
+    ~accelerated();
     void destroy();
+    void flatten();
+    bool take_transformed(accelerated &prev);
+    bool take_transformed(accelerated &&prev);
     void add(scene_object* obj);
     void invert();
+    void set_samples(const std::vector<R2> &samples_in);
 };
 
 inline accelerated::accelerated()
     : samples{make_R2(0, 0)}
     , threads(1)
+    , block(0)
+    , tile(32)
+    , stats(false)
+    , mode(e_render_mode::pixels)
+    , aa(e_aa_mode::full)
+    , resolve(e_resolve_mode::integer)
+    , simd(e_simd_mode::off)
+    , precision(e_precision_mode::full)
+    , flatness(0.0)
 {}
 
+inline accelerated::accelerated(accelerated &&rhs)
+    : accelerated() {
+    *this = std::move(rhs);
+}
+
+inline accelerated::~accelerated() {
+    destroy();
+}
+
 inline void accelerated::add(scene_object* obj){
-    objects.push_back(obj);
+    objects.emplace_back(obj);
 }
 
 inline void accelerated::invert() {
     std::reverse(objects.begin(), objects.end());
 }
 
+inline void accelerated::set_samples(const std::vector<R2> &samples_in) {
+    samples = samples_in;
+    R2 p0 = samples[0];
+    R2 p1 = samples[0];
+    for(auto &sp : samples) {
+        p0 = make_R2(std::min(p0[0], sp[0]), std::min(p0[1], sp[1]));
+        p1 = make_R2(std::max(p1[0], sp[0]), std::max(p1[1], sp[1]));
+    }
+    footprint = bouding_box(p0, p1);
+}
+
 } // hadryan
 
 #endif // HADRYAN_ACCELERATED_H
\ No newline at end of file
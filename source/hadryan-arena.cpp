@@ -0,0 +1,98 @@
+#include "hadryan-arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <omp.h>
+
+namespace hadryan {
+
+arena::arena(int threads) {
+    int n = std::max(threads, omp_get_max_threads());
+    for(int i = 0; i < n; i++) {
+        m_slots.emplace_back(new slot);
+    }
+}
+
+// nested teams reuse thread numbers, so only the outermost one has
+// slots of its own
+arena::slot* arena::get_slot() {
+    int t = omp_get_thread_num();
+    if(omp_get_level() <= 1 && t < (int) m_slots.size()) {
+        return m_slots[t].get();
+    }
+    return nullptr;
+}
+
+// offset of the first address at or after offset used in c that is a
+// multiple of align, as chunks themselves are only aligned for the
+// fundamental types
+static size_t align_in(const char* data, size_t used, size_t align) {
+    uintptr_t p = reinterpret_cast<uintptr_t>(data) + used;
+    return used + ((align - p % align) % align);
+}
+
+void* arena::allocate(slot &s, size_t bytes, size_t align) {
+    if(!s.chunks.empty()) {
+        chunk &c = s.chunks[s.current];
+        size_t begin = align_in(c.data.get(), s.used, align);
+        if(begin + bytes <= c.size) {
+            s.used = begin + bytes;
+            return c.data.get() + begin;
+        }
+        s.current++;
+    }
+    // chunks left behind by a rewind are reused when large enough
+    size_t needed = bytes + align-1;
+    if(s.current == s.chunks.size() || s.chunks[s.current].size < needed) {
+        chunk c;
+        c.size = std::max(needed, chunk_size);
+        c.data.reset(new char[c.size]);
+        s.chunks.insert(s.chunks.begin()+s.current, std::move(c));
+    }
+    chunk &c = s.chunks[s.current];
+    size_t begin = align_in(c.data.get(), 0, align);
+    s.used = begin + bytes;
+    return c.data.get() + begin;
+}
+
+void* arena::allocate(size_t bytes, size_t align) {
+    slot* s = get_slot();
+    if(s != nullptr) {
+        return allocate(*s, bytes, align);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return allocate(m_shared, bytes, align);
+}
+
+arena::mark arena::get_mark() {
+    mark m;
+    m.m_slot = get_slot();
+    if(m.m_slot != nullptr) {
+        m.m_current = m.m_slot->current;
+        m.m_used = m.m_slot->used;
+    }
+    return m;
+}
+
+// the shared slot interleaves threads, so nothing is dropped from it
+void arena::rewind(const mark &m) {
+    if(m.m_slot != nullptr) {
+        m.m_slot->current = m.m_current;
+        m.m_slot->used = m.m_used;
+    }
+}
+
+size_t arena::get_reserved() const {
+    size_t total = 0;
+    for(auto &c : m_shared.chunks) {
+        total += c.size;
+    }
+    for(auto &s : m_slots) {
+        for(auto &c : s->chunks) {
+            total += c.size;
+        }
+    }
+    return total;
+}
+
+} // hadryan
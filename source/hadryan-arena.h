@@ -0,0 +1,73 @@
+#ifndef HADRYAN_ARENA_H
+#define HADRYAN_ARENA_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <cstddef>
+
+namespace hadryan {
+
+// Memory of one tree build. Every thread of an OpenMP team carves its
+// allocations from chunks of its own slot, so builds take no lock, and
+// everything is released at once with the arena. Objects placed in it
+// are never destroyed, so they must own nothing outside of it.
+class arena {
+    struct chunk {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+    struct slot {
+        std::vector<chunk> chunks;
+        size_t current = 0;
+        size_t used = 0;
+    };
+    static constexpr size_t chunk_size = 1 << 20;
+    std::vector<std::unique_ptr<slot>> m_slots;
+    // taken by threads outside the team the arena was sized for
+    slot m_shared;
+    std::mutex m_mutex;
+
+    arena(const arena &rhs) = delete;
+    arena& operator=(const arena &rhs) = delete;
+    slot* get_slot();
+    static void* allocate(slot &s, size_t bytes, size_t align);
+public:
+    // allocation point of the calling thread, to drop what follows it
+    class mark {
+        friend class arena;
+        slot* m_slot;
+        size_t m_current;
+        size_t m_used;
+    };
+    arena(int threads);
+    void* allocate(size_t bytes, size_t align);
+    template <typename T, typename... ARGS> T* make(ARGS&&... args);
+    template <typename T> T* copy(const T* first, size_t n);
+    mark get_mark();
+    void rewind(const mark &m);
+    size_t get_reserved() const;
+};
+
+template <typename T, typename... ARGS>
+inline T* arena::make(ARGS&&... args) {
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<ARGS>(args)...);
+}
+
+template <typename T>
+inline T* arena::copy(const T* first, size_t n) {
+    if(n == 0) {
+        return nullptr;
+    }
+    T* data = static_cast<T*>(allocate(n*sizeof(T), alignof(T)));
+    for(size_t i = 0; i < n; i++) {
+        new (data+i) T(first[i]);
+    }
+    return data;
+}
+
+} // hadryan
+
+#endif // HADRYAN_ARENA_H
@@ -0,0 +1,74 @@
+#ifndef HADRYAN_BLOCK_INDEX_H
+#define HADRYAN_BLOCK_INDEX_H
+
+#include <vector>
+#include <cmath>
+
+using namespace rvg;
+
+namespace hadryan {
+
+// Dense table with one entry per block of size x size pixels of the
+// viewport, pointing to the leaf that holds every pixel center of the
+// block. Blocks crossed by a leaf boundary are mixed (nullptr) and
+// fall back to the tree.
+template <typename TREE, typename LEAF>
+class block_index {
+    const TREE* m_tree;
+    int m_x0;
+    int m_y0;
+    int m_size;
+    int m_nx;
+    int m_ny;
+    std::vector<const LEAF*> m_blocks;
+public:
+    block_index(const TREE* tree, int x0, int y0, int width, int height,
+        int size);
+    const LEAF* get_node_of(const double &x, const double &y) const;
+};
+
+template <typename TREE, typename LEAF>
+block_index<TREE, LEAF>::block_index(const TREE* tree, int x0, int y0,
+    int width, int height, int size)
+    : m_tree(tree)
+    , m_x0(x0)
+    , m_y0(y0)
+    , m_size(size)
+    , m_nx((width+size-1)/size)
+    , m_ny((height+size-1)/size)
+    , m_blocks(m_nx*m_ny, nullptr) {
+    if(tree == nullptr) {
+        return;
+    }
+    for(int by = 0; by < m_ny; by++) {
+        for(int bx = 0; bx < m_nx; bx++) {
+            // first and last pixel centers of the block
+            double cx0 = x0 + bx*size + 0.5;
+            double cy0 = y0 + by*size + 0.5;
+            double cx1 = std::min(cx0 + size, (double) x0 + width) - 1;
+            double cy1 = std::min(cy0 + size, (double) y0 + height) - 1;
+            const LEAF* nod = tree->get_node_of(cx0, cy0);
+            if(nod != nullptr && cx1 < nod->get_p1()[0] && cy1 < nod->get_p1()[1]) {
+                m_blocks[by*m_nx + bx] = nod;
+            }
+        }
+    }
+}
+
+template <typename TREE, typename LEAF>
+inline const LEAF* block_index<TREE, LEAF>::get_node_of(const double &x,
+    const double &y) const {
+    int dx = (int) std::floor(x) - m_x0;
+    int dy = (int) std::floor(y) - m_y0;
+    if(dx >= 0 && dy >= 0 && dx < m_nx*m_size && dy < m_ny*m_size) {
+        const LEAF* nod = m_blocks[(dy/m_size)*m_nx + dx/m_size];
+        if(nod != nullptr) {
+            return nod;
+        }
+    }
+    return m_tree != nullptr ? m_tree->get_node_of(x, y) : nullptr;
+}
+
+} // hadryan
+
+#endif // HADRYAN_BLOCK_INDEX_H
@@ -1,6 +1,8 @@
 #ifndef HADRYAN_BOUDING_BOX_H
 #define HADRYAN_BOUDING_BOX_H
 
+#include <algorithm>
+
 #include "rvg-point.h"
 
 using namespace rvg;
@@ -17,6 +19,11 @@ public:
     bool hit_right(double x, double y) const;
     bool hit_inside(double x, double y) const;
     bool intersect(const bouding_box &rhs) const;
+    bool hit_inside_constant(const bouding_box &area) const;
+    bool contains(const bouding_box &area) const;
+    double overlap(const bouding_box &rhs) const;
+    const R2& get_p0() const;
+    const R2& get_p1() const;
 private:
     R2 m_p0;
     R2 m_p1;
@@ -53,6 +60,33 @@ inline bool bouding_box::intersect(const bouding_box &rhs) const {
            rhs.m_p1[1] > m_p0[1];
 }
 
+// true if hit_inside gives the same answer for every point of area
+inline bool bouding_box::hit_inside_constant(const bouding_box &area) const {
+    return contains(area) || area.m_p1[0] < m_p0[0] || area.m_p0[0] >= m_p1[0] ||
+           area.m_p1[1] < m_p0[1] || area.m_p0[1] >= m_p1[1];
+}
+
+// true if hit_inside holds for every point of area
+inline bool bouding_box::contains(const bouding_box &area) const {
+    return area.m_p0[0] >= m_p0[0] && area.m_p1[0] < m_p1[0] &&
+           area.m_p0[1] >= m_p0[1] && area.m_p1[1] < m_p1[1];
+}
+
+// area of the intersection with rhs
+inline double bouding_box::overlap(const bouding_box &rhs) const {
+    double w = std::min(m_p1[0], rhs.m_p1[0]) - std::max(m_p0[0], rhs.m_p0[0]);
+    double h = std::min(m_p1[1], rhs.m_p1[1]) - std::max(m_p0[1], rhs.m_p0[1]);
+    return (w > 0 && h > 0) ? w*h : 0.0;
+}
+
+inline const R2& bouding_box::get_p0() const {
+    return m_p0;
+}
+
+inline const R2& bouding_box::get_p1() const {
+    return m_p1;
+}
+
 } // hadryan
 
 #endif // HADRYAN_BOUDING_BOX_H
\ No newline at end of file
@@ -9,6 +9,19 @@ color_solver::color_solver(const paint& pat)
     , m_inv_xf(m_paint.get_xf().inverse())
 {}
 
+color_solver* color_solver::clone() const {
+    return new color_solver(*this);
+}
+
+void color_solver::translate(const R2 &d) {
+    m_inv_xf = m_inv_xf * make_translation(-d[0], -d[1]);
+}
+
+// xf maps the old screen space to the new one
+void color_solver::transform(const xform &xf) {
+    m_inv_xf = m_inv_xf * xf.inverse();
+}
+
 double color_solver::spread(e_spread spread, double t) const {
     double rt = t;
     if(t < 0 || t > 1) {
@@ -12,10 +12,14 @@ public:
     color_solver(const paint& pat);
     virtual ~color_solver() = default;
     virtual RGBA8 solve(double x, double y) const;
+    // a copy, for a scene_object moved while its original is kept
+    virtual color_solver* clone() const;
+    void translate(const R2 &d);
+    void transform(const xform &xf);
 
 protected:
     paint m_paint;
-    const xform m_inv_xf;
+    xform m_inv_xf;
     double spread(e_spread spread, double t) const;
 };
 
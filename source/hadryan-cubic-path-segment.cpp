@@ -1,11 +1,15 @@
 #include "hadryan-cubic-path-segment.h"
 
+#include "hadryan-segment-row.h"
+
 using namespace rvg;
 
 namespace hadryan {
 
 cubic::cubic(const R2 &p0, const R2 &p1, const R2 &p2, const R2 &p3)
-    : path_segment(p0, p3) {
+    : path_segment(p0, p3)
+    , m_c1(p1 - p0)
+    , m_c2(p2 - p0) {
     constexpr double BEZIER_EPS = 0.0001f;
     double x1, x2, x3;
     double y1, y2, y3;
@@ -99,4 +103,35 @@ bool cubic::implicit_hit(double x, double y) const {
            (hits == 1 && hit_me(x, y)));
 }
 
+path_segment* cubic::clone() const {
+    return new cubic(*this);
+}
+
+path_segment* cubic::transformed(const xform &xf) const {
+    return new cubic(off_grid(R2(xf.apply(m_pi))), off_grid(R2(xf.apply(m_pi + m_c1))),
+        off_grid(R2(xf.apply(m_pi + m_c2))), off_grid(R2(xf.apply(m_pf))));
+}
+
+// the triangle starts and ends at the first end point, the origin
+int cubic::get_row(double* row) const {
+    get_common_row(row);
+    R2 v = m_tri[0].last();
+    R2 w = m_tri[1].last();
+    row[segment_row::vx] = v[0];
+    row[segment_row::vy] = v[1];
+    row[segment_row::wx] = w[0];
+    row[segment_row::wy] = w[1];
+    row[segment_row::ca] = A;
+    row[segment_row::cb] = B;
+    row[segment_row::cc] = C;
+    row[segment_row::cd] = D;
+    row[segment_row::ce] = E;
+    row[segment_row::cf] = F;
+    row[segment_row::cg] = G;
+    row[segment_row::ch] = H;
+    row[segment_row::ci] = I;
+    row[segment_row::cder] = m_der;
+    return segment_row::cubic_kind;
+}
+
 } // hadryan
\ No newline at end of file
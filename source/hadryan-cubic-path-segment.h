@@ -15,6 +15,10 @@ public:
     int triangle_hits(double x, double y) const;
     bool hit_me(double x, double y) const;
     bool implicit_hit(double x, double y) const;
+    double get_cost() const {return 6.0;}
+    path_segment* clone() const;
+    path_segment* transformed(const xform &xf) const;
+    int get_row(double* row) const;
 
 private:
     double A;
@@ -28,6 +32,9 @@ private:
     double I;
     double m_der;
     std::vector<linear> m_tri; 
+    // inner control points, relative to m_pi
+    R2 m_c1;
+    R2 m_c2;
 };
 
 inline bool cubic::hit_me(double x, double y) const {
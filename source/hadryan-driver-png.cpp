@@ -1,5 +1,9 @@
 #include "hadryan-driver-png.h"
 
+#include <cerrno>
+#include <cctype>
+#include <cstring>
+
 #include "rvg-image.h"
 #include "rvg-pngio.h"
 #include "rvg-lua.h"
@@ -8,29 +12,42 @@
 #include "hadryan-accelerated-builder.h"
 #include "hadryan-tree-node.h"
 #include "hadryan-leave-node.h"
+#include "hadryan-lazy-node.h"
+#include "hadryan-flat-tree.h"
+#include "hadryan-grid.h"
+#include "hadryan-block-index.h"
 #include "hadryan-quad-tree-auxiliar.h"
+#include "hadryan-gamma.h"
+#include "hadryan-tiles.h"
 
 using namespace rvg;
 
 namespace hadryan {
 
-const accelerated accelerate(const scene &c, const window &w,
+accelerated accelerate(const scene &c, const window &w,
     const viewport &v, const std::vector<std::string> &args) {
-    int xl, yb, xr, yt;
-    std::tie(xl, yb) = v.bl();
-    std::tie(xr, yt) = v.tr();
-    int max_depth_ = std::log2(std::min(xr-xl, yt-yb)/2.0);
-    tree_node::set_max_depth(max_depth_); // depth to each cell contain at least 4 sampless
-    accelerated acc;
-    accelerated_builder builder(acc, args, make_windowviewport(w, v) * c.get_xf());
-    c.get_scene_data().iterate(builder);
-    acc.invert();
-    leave_node* first_leave = new leave_node(make_R2(xl, yb), make_R2(xr, yt));
-    for(auto &obj : acc.objects) {
-        node_object node_obj(obj);
+    return accelerate(c, w, v, xform(), args);
+}
+
+// builds the tree over the viewport cells from acc.objects
+static void build_tree(accelerated &acc, int xl, int yb, int xr, int yt) {
+    acc.tree_arena = new arena(acc.threads);
+    arena &a = *acc.tree_arena;
+    bouding_box cell(make_R2(xl, yb), make_R2(xr, yt));
+    // objects are clipped to the root cell in parallel, each into its
+    // own slot, and then added in order
+    int n_objects = acc.objects.size();
+    std::vector<node_object> clipped(n_objects);
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(acc.threads)
+    for(int i = 0; i < n_objects; i++) {
+        static thread_local node_object_builder node_obj;
+        const scene_object* obj = acc.objects[i].get();
+        node_obj.reset(obj);
         // insert in a node if collides with cell
-        if(first_leave->intersect(obj->get_bbox())){
-            for(auto &seg : obj->get_path()) {
+        if(cell.intersect(obj->get_bbox())){
+            int n_path = obj->get_path().size();
+            for(int j = 0; j < n_path; j++) {
+                const path_segment* seg = obj->get_path()[j];
                 bool hit_br_tr = hit_v_bound(xr, yb, yt, seg);
                 bool hit_bl_br = hit_h_bound(yb, xl, xr, seg);
                 bool hit_bl_tl = hit_v_bound(xl, yb, yt, seg);
@@ -38,32 +55,184 @@ const accelerated accelerate(const scene &c, const window &w,
                 bool total_inside = totally_inside(xl, xr, yb, yt, seg);
                 bool inside = (total_inside || hit_br_tr || hit_bl_br || hit_bl_tl || hit_tl_tr);
                 if(inside) {
-                    node_obj.add_segment(seg, hit_br_tr);
+                    node_obj.add_segment(j, hit_br_tr);
                 }
                 bool hit_br(seg->intersect(xr, yb));
                 if(hit_br) {
                     node_obj.increment(seg->get_dir());
                 }
             }
-            if(node_obj.get_size() || node_obj.get_increment() != 0) {
-                first_leave->add_node_object(node_obj);
-            }
+        }
+        if(node_obj.get_size() || node_obj.get_increment() != 0) {
+            clipped[i] = node_obj.build(a);
+        }
+    }
+    leave_builder first;
+    first.reset(make_R2(xl, yb), make_R2(xr, yt));
+    for(auto &node_obj : clipped) {
+        if(node_obj.m_ptr != nullptr) {
+            first.add_node_object(node_obj);
         }
     }
+    leave_node* first_leave = first.build(a);
+    if(acc.config.accel == e_accel_mode::grid) {
+        int size = acc.config.grid_size > 0 ? acc.config.grid_size : 
+            grid::auto_size(first_leave);
+        acc.cells = new grid(first_leave, size, acc.threads, a);
+        if(acc.stats) {
+            fprintf(stderr, "tree arena %.1fMB\n", a.get_reserved()/1048576.0);
+        }
+        return;
+    }
+    if(acc.config.build == e_build_mode::lazy && acc.mode == e_render_mode::pixels) {
+        // render threads expand the leaves they sample, and the
+        // pointer layout is kept so there is something to expand;
+        // the leaves render mode walks every leaf and builds eagerly
+        acc.root = a.make<lazy_node>(first_leave, acc.config, a);
+        return;
+    }
+    task_report tasks(acc.threads);
     #pragma omp parallel num_threads(acc.threads)
     {
         #pragma omp single
         {
-            acc.root = first_leave->subdivide();
+            acc.root = first_leave->subdivide(acc.config, a, 0, 
+                acc.stats ? &tasks : nullptr);
+        }
+    }
+    if(acc.stats) {
+        fprintf(stderr, "tree arena %.1fMB\n", a.get_reserved()/1048576.0);
+        tasks.print(stderr);
+    }
+    // the segment_store belongs to the flat layout
+    if(acc.config.layout == e_tree_layout::flat || acc.config.store == e_store_mode::soa) {
+        acc.flatten();
+        if(acc.stats && acc.flat != nullptr) {
+            fprintf(stderr, "flat tree %.1fMB\n", acc.flat->get_reserved()/1048576.0);
         }
     }
-    if(first_leave != acc.root) {
-        delete first_leave;
+}
+
+// maps the blocks of the viewport to their leaves once, for every
+// render of acc. A lazy tree is left without one, as finding the leaf
+// of each block would expand all of it; the grid finds its cells
+// without a descent anyway.
+static void build_index(accelerated &acc, int xl, int yb, int xr, int yt) {
+    if(acc.block <= 0 || acc.mode != e_render_mode::pixels ||
+        acc.config.build == e_build_mode::lazy) {
+        return;
     }
-    return std::move(acc);
+    if(acc.flat != nullptr) {
+        acc.flat_index = new block_index<flat_tree, flat_leaf>(acc.flat,
+            xl, yb, xr-xl, yt-yb, acc.block);
+    } else if(acc.root != nullptr) {
+        acc.root_index = new block_index<tree_node, leave_node>(acc.root,
+            xl, yb, xr-xl, yt-yb, acc.block);
+    }
+}
+
+// size of the leaves, and the segment tests an average sample makes
+// when it tests every segment and shortcut of its leaf
+template <typename LEAF>
+static void report_leaves(const std::vector<const LEAF*> &leaves, 
+    const char *what, FILE *out) {
+    long objects = 0;
+    long refs = 0;
+    double area = 0.0;
+    double tests = 0.0;
+    for(auto nod : leaves) {
+        double a = (nod->get_p1()[0]-nod->get_p0()[0])*(nod->get_p1()[1]-nod->get_p0()[1]);
+        long r = 0;
+        for(auto &obj : nod->get_objects()) {
+            objects++;
+            r += obj.get_size();
+        }
+        refs += r;
+        area += a;
+        tests += a*r;
+    }
+    fprintf(out, "%s %zu leaves %ld node objects %ld segment references\n",
+        what, leaves.size(), objects, refs);
+    fprintf(out, "%s %.2f segment tests per sample\n", what, area > 0 ? tests/area : 0.0);
+}
+
+template <typename TREE, typename LEAF>
+static void report_tree(const TREE* tree, FILE *out) {
+    std::vector<const LEAF*> leaves;
+    tree->get_leaves(leaves);
+    fprintf(out, "tree %zu intern nodes\n", (leaves.size()-1)/3);
+    report_leaves(leaves, "tree", out);
+}
+
+static void report_grid(const grid* cells, FILE *out) {
+    std::vector<const leave_node*> leaves;
+    cells->get_leaves(leaves);
+    fprintf(out, "grid %dx%d cells of %dpx\n", cells->get_columns(), 
+        cells->get_rows(), cells->get_size());
+    report_leaves(leaves, "grid", out);
+}
+
+// frame_xf is applied in screen space, after the window-viewport
+accelerated accelerate(const scene &c, const window &w,
+    const viewport &v, const xform &frame_xf, 
+    const std::vector<std::string> &args) {
+    return accelerate(c, w, v, frame_xf, args, accelerated());
+}
+
+// when previous was built from the same scene data with a transform
+// that differs only by a translation, or by a scale along the axes as
+// for another viewport size or zoom, its objects are reused, given up
+// by previous when release is set
+static accelerated accelerate_from(const scene &c, const window &w,
+    const viewport &v, const xform &frame_xf, 
+    const std::vector<std::string> &args, accelerated &previous, bool release) {
+    int xl, yb, xr, yt;
+    std::tie(xl, yb) = v.bl();
+    std::tie(xr, yt) = v.tr();
+    accelerated acc;
+    acc.source = c.get_scene_data_ptr();
+    // depth to each cell contain at least 4 samples, -depth overrides it
+    acc.config.max_depth = std::log2(std::min(xr-xl, yt-yb)/2.0);
+    double start = omp_get_wtime();
+    accelerated_builder builder(acc, args, 
+        frame_xf * make_windowviewport(w, v) * c.get_xf());
+    if(!(release ? acc.take_transformed(std::move(previous)) :
+        acc.take_transformed(previous))) {
+        c.get_scene_data().iterate(builder);
+        builder.convert();
+        acc.invert();
+    }
+    double built = omp_get_wtime();
+    build_tree(acc, xl, yb, xr, yt);
+    build_index(acc, xl, yb, xr, yt);
+    if(acc.stats) {
+        fprintf(stderr, "build scene %.3fs tree %.3fs\n", built - start, 
+            omp_get_wtime() - built);
+        if(acc.cells != nullptr) {
+            report_grid(acc.cells, stderr);
+        } else if(acc.flat != nullptr) {
+            report_tree<flat_tree, flat_leaf>(acc.flat, stderr);
+        } else if(acc.root != nullptr) {
+            report_tree<tree_node, leave_node>(acc.root, stderr);
+        }
+    }
+    return acc;
+}
+
+accelerated accelerate(const scene &c, const window &w,
+    const viewport &v, const xform &frame_xf, 
+    const std::vector<std::string> &args, accelerated &previous) {
+    return accelerate_from(c, w, v, frame_xf, args, previous, false);
 }
 
-inline RGBA8 sample_cell(const leave_node* nod, const double &x, const double &y) {
+accelerated accelerate(const scene &c, const window &w,
+    const viewport &v, const xform &frame_xf, 
+    const std::vector<std::string> &args, accelerated &&previous) {
+    return accelerate_from(c, w, v, frame_xf, args, previous, true);
+}
+
+template <typename LEAF>
+inline RGBA8 sample_cell(const LEAF* nod, const double &x, const double &y) {
     RGBA8 c = make_rgba8(0, 0, 0, 0);
     for(auto &nobj : nod->get_objects()) {
         if(nobj.hit(x, y)) {
@@ -76,50 +245,440 @@ inline RGBA8 sample_cell(const leave_node* nod, const double &x, const double &y
     return over(c, make_rgba8(255, 255, 255, 255)); 
 }
 
-inline RGBA8 sample(const accelerated& a, float x, float y){
-   if(a.root != nullptr) {
-        auto nod = a.root->get_node_of(x, y);
-        if(nod != nullptr) {
-            std::vector<int> color{0, 0, 0, 255};
-            for(auto &sp : a.samples) {
-                double mx = x + sp[0];
-                double my = y + sp[1];
-                RGBA8 sp_color(remove_gamma(sample_cell(nod, mx, my)));
-                color[0] += (int)sp_color[0];
-                color[1] += (int)sp_color[1];
-                color[2] += (int)sp_color[2];
+// sample_cell for all the lanes at once. Objects are composited in the
+// same order for each lane, and a lane closes once it is opaque.
+template <typename LEAF>
+inline void sample_cell_lanes(const LEAF* nod, const sample_lanes &lanes,
+    const lane_kernels &k, RGBA8* colors) {
+    for(int s = 0; s < lanes.n; s++) {
+        colors[s] = make_rgba8(0, 0, 0, 0);
+    }
+    uint64_t open = lanes.all();
+    for(auto &nobj : nod->get_objects()) {
+        for(uint64_t m = nobj.hit_lanes(lanes, open, k); m != 0; m &= m - 1) {
+            int s = __builtin_ctzll(m);
+            colors[s] = over(colors[s], pre_multiply(nobj.get_color(lanes.x[s], lanes.y[s])));
+            if((int) colors[s][3] == 255) {
+                open &= ~((uint64_t) 1 << s);
+            }
+        }
+        if(open == 0) {
+            return;
+        }
+    }
+    for(; open != 0; open &= open - 1) {
+        int s = __builtin_ctzll(open);
+        colors[s] = over(colors[s], make_rgba8(255, 255, 255, 255));
+    }
+}
+
+// kernels for the samples of a pixel, if they go through the lanes.
+// Single precision only exists in the lanes, so it turns them on.
+inline const lane_kernels* pixel_lanes(const accelerated& a, int n_samples) {
+    if(n_samples == 1 || n_samples > sample_lanes::max_lanes) {
+        return nullptr;
+    }
+    if(a.simd == e_simd_mode::off && a.precision == e_precision_mode::single) {
+        return lane_kernels::get(e_simd_mode::automatic, a.precision);
+    }
+    return lane_kernels::get(a.simd, a.precision);
+}
+
+// when every object in the cell covers either all or none of the
+// pixel footprint and has a solid color, all samples agree
+template <typename LEAF>
+inline bool constant_pixel(const accelerated& a, const LEAF* nod, float x, float y) {
+    if(a.aa != e_aa_mode::adaptive || a.samples.size() == 1 || !nod->is_solid()) {
+        return false;
+    }
+    const R2 &f0 = a.footprint.get_p0();
+    const R2 &f1 = a.footprint.get_p1();
+    bouding_box area(make_R2(x + f0[0], y + f0[1]), make_R2(x + f1[0], y + f1[1]));
+    return nod->hit_constant(area);
+}
+
+// fraction of the pattern samples around x, y that hit nobj
+template <typename OBJECT>
+inline double sampled_cover(const accelerated& a, const OBJECT &nobj, float x, float y) {
+    int hits = 0;
+    for(auto &s : a.samples) {
+        hits += nobj.hit(x + s[0], y + s[1]);
+    }
+    return hits/(double) a.samples.size();
+}
+
+// covers this close to 0 or 1 are rounding in the sum of the areas of
+// float points, which differs with the segments each leaf holds
+constexpr double min_cover = 1e-6;
+
+// Box filtered pixel color in linear light, from the exact area an
+// object covers, or the fraction of the samples it hits when a curve
+// crosses the pixel. Objects are composited front to back as in
+// sample_cell, down to where the pixel is opaque. With a single object
+// covering part of the pixel, it splits into the part inside and the
+// part outside that object, each of one sample_cell color, which are
+// mixed in linear light in proportion to their areas. The area each of
+// two such objects covers says nothing of how much they overlap, so
+// false leaves those pixels to the samples.
+template <typename LEAF>
+inline bool sample_analytic(const accelerated& a, const LEAF* nod, float x, float y, float* rgb){
+    RGBA8 inside = make_rgba8(0, 0, 0, 0);
+    RGBA8 outside = make_rgba8(0, 0, 0, 0);
+    float part = 0.f;
+    bouding_box pixel(make_R2(x - 0.5, y - 0.5), make_R2(x + 0.5, y + 0.5));
+    for(auto &nobj : nod->get_objects()) {
+        double cover;
+        if(!nobj.cover(pixel, cover)) {
+            cover = sampled_cover(a, nobj, x, y);
+        }
+        if(cover <= min_cover) {
+            continue;
+        }
+        RGBA8 color = pre_multiply(nobj.get_color(x, y));
+        if(cover < 1.0 - min_cover) {
+            if(part > 0.f) {
+                return false;
             }
-            color[0] /= a.samples.size();
-            color[1] /= a.samples.size();
-            color[2] /= a.samples.size();
-            return add_gamma(make_rgba8(color[0], color[1], color[2], color[3]));
+            part = (float) cover;
+        } else {
+            outside = over(outside, color);
+        }
+        inside = over(inside, color);
+        if((int) inside[3] == 255 && (int) outside[3] == 255) {
+            break;
+        }
+    }
+    const float* decode = gamma_lut::get_decode();
+    inside = over(inside, make_rgba8(255, 255, 255, 255));
+    outside = over(outside, make_rgba8(255, 255, 255, 255));
+    for(int k = 0; k < 3; k++) {
+        rgb[k] = part*decode[(int) inside[k]] + (1.f - part)*decode[(int) outside[k]];
+    }
+    return true;
+}
+
+template <typename LEAF>
+inline RGBA8 sample(const accelerated& a, const LEAF* nod, float x, float y){
+    float rgb[3];
+    if(a.aa == e_aa_mode::analytic && sample_analytic(a, nod, x, y, rgb)) {
+        uint8_t srgb[3];
+        gamma_lut::encode(rgb, 3, srgb);
+        return make_rgba8(srgb[0], srgb[1], srgb[2], 255);
+    }
+    int color[3] = {0, 0, 0};
+    int n_samples = constant_pixel(a, nod, x, y) ? 1 : a.samples.size();
+    const lane_kernels* k = pixel_lanes(a, n_samples);
+    RGBA8 colors[sample_lanes::max_lanes];
+    if(k != nullptr) {
+        sample_lanes lanes;
+        lanes.set(a.samples.data(), n_samples, x, y);
+        sample_cell_lanes(nod, lanes, *k, colors);
+    }
+    for(int s = 0; s < n_samples; s++) {
+        double mx = x + a.samples[s][0];
+        double my = y + a.samples[s][1];
+        RGBA8 sp_color(remove_gamma(k != nullptr ? colors[s] : sample_cell(nod, mx, my)));
+        color[0] += (int)sp_color[0];
+        color[1] += (int)sp_color[1];
+        color[2] += (int)sp_color[2];
+    }
+    color[0] /= n_samples;
+    color[1] /= n_samples;
+    color[2] /= n_samples;
+    return add_gamma(make_rgba8(color[0], color[1], color[2], 255));
+}
+
+// averages the samples in linear light without quantizing them,
+// leaving the gamma encoding to linear_span::store
+template <typename LEAF>
+inline void sample_linear(const accelerated& a, const LEAF* nod, float x, float y, float* rgb){
+    if(a.aa == e_aa_mode::analytic && sample_analytic(a, nod, x, y, rgb)) {
+        return;
+    }
+    const float* decode = gamma_lut::get_decode();
+    float r = 0.f, g = 0.f, b = 0.f;
+    int n_samples = constant_pixel(a, nod, x, y) ? 1 : a.samples.size();
+    const lane_kernels* k = pixel_lanes(a, n_samples);
+    RGBA8 colors[sample_lanes::max_lanes];
+    if(k != nullptr) {
+        sample_lanes lanes;
+        lanes.set(a.samples.data(), n_samples, x, y);
+        sample_cell_lanes(nod, lanes, *k, colors);
+    }
+    for(int s = 0; s < n_samples; s++) {
+        double mx = x + a.samples[s][0];
+        double my = y + a.samples[s][1];
+        RGBA8 sp_color(k != nullptr ? colors[s] : sample_cell(nod, mx, my));
+        r += decode[(int)sp_color[0]];
+        g += decode[(int)sp_color[1]];
+        b += decode[(int)sp_color[2]];
+    }
+    float inv = 1.f/n_samples;
+    rgb[0] = r*inv;
+    rgb[1] = g*inv;
+    rgb[2] = b*inv;
+}
+
+template <typename TREE>
+inline RGBA8 sample_tree(const accelerated& a, const TREE* tree, float x, float y){
+   if(tree != nullptr) {
+        auto nod = tree->get_node_of(x, y);
+        if(nod != nullptr) {
+            return sample(a, nod, x, y);
         }
     }
     return RGBA8(255,255,255,255);
 }
 
-void render(accelerated &a, const window &w, const viewport &v,
-    FILE *out, const std::vector<std::string> &args) {
-    (void) args;
-    (void) w;
+template <typename TREE>
+inline void sample_tree_linear(const accelerated& a, const TREE* tree, float x, float y, float* rgb){
+   if(tree != nullptr) {
+        auto nod = tree->get_node_of(x, y);
+        if(nod != nullptr) {
+            sample_linear(a, nod, x, y, rgb);
+            return;
+        }
+    }
+    rgb[0] = rgb[1] = rgb[2] = 1.f;
+}
+
+// per-thread buffers holding a run of pixels of one row in linear
+// light, so they are gamma encoded together
+class linear_span {
+    std::vector<float> m_rgb;
+    std::vector<uint8_t> m_srgb;
+public:
+    linear_span(int width)
+        : m_rgb(3*width)
+        , m_srgb(3*width)
+    {}
+    float* at(int k) {
+        return &m_rgb[3*k];
+    }
+    void store(image<uint8_t, 4> &out_image, int px, int py, int n) {
+        gamma_lut::encode(m_rgb.data(), 3*n, m_srgb.data());
+        for(int k = 0; k < n; k++) {
+            out_image.set_pixel(px+k, py, m_srgb[3*k], m_srgb[3*k+1], m_srgb[3*k+2], 255);
+        }
+    }
+};
+
+// samples every pixel center inside each leaf's rectangle, so the
+// leaf is found once instead of descending the tree per pixel
+template <typename TREE, typename LEAF>
+void render_leaves(const accelerated &a, const TREE* tree, int xl, int yb, 
+    image<uint8_t, 4> &out_image) {
+    std::vector<const LEAF*> leaves;
+    tree->get_leaves(leaves);
+    int n_leaves = leaves.size();
+    thread_report report(a.threads);
+    #pragma omp parallel num_threads(a.threads)
+    {
+        linear_span span(a.resolve == e_resolve_mode::linear ? out_image.get_width() : 0);
+        #pragma omp for schedule(dynamic)
+        for(int l = 0; l < n_leaves; l++) {
+            double start = omp_get_wtime();
+            auto nod = leaves[l];
+            int x0 = (int) nod->get_p0()[0];
+            int x1 = (int) nod->get_p1()[0];
+            for(int py = (int) nod->get_p0()[1]; py < (int) nod->get_p1()[1]; py++) {
+                if(a.resolve == e_resolve_mode::linear) {
+                    for(int px = x0; px < x1; px++) {
+                        sample_linear(a, nod, px+0.5, py+0.5, span.at(px-x0));
+                    }
+                    span.store(out_image, x0-xl, py-yb, x1-x0);
+                    continue;
+                }
+                for(int px = x0; px < x1; px++) {
+                    double x = px+0.5;
+                    double y = py+0.5;
+                    RGBA8 g_color(sample(a, nod, x, y));
+                    out_image.set_pixel(px-xl, py-yb, g_color[0], g_color[1], g_color[2], 255);
+                }
+            }
+            report.add(omp_get_wtime() - start);
+        }
+    }
+    report.stop();
+    if(a.stats) {
+        report.print(stderr, "leaves");
+    }
+}
+
+// samples every pixel, finding its leaf through the lookup, either
+// the tree itself or a block_index over it. Threads take the tiles
+// one at a time, most expensive first.
+template <typename LOOKUP>
+void render_pixels(const accelerated &a, const LOOKUP* lookup, int xl, int yb, 
+    const std::vector<tile> &tiles, image<uint8_t, 4> &out_image) {
+    int n_tiles = tiles.size();
+    thread_report report(a.threads);
+    #pragma omp parallel num_threads(a.threads)
+    {
+        linear_span span(a.resolve == e_resolve_mode::linear ? a.tile : 0);
+        #pragma omp for schedule(dynamic, 1)
+        for(int k = 0; k < n_tiles; k++) {
+            double start = omp_get_wtime();
+            const tile &t = tiles[k];
+            for(int py = t.y0; py < t.y1; py++) {
+                if(a.resolve == e_resolve_mode::linear) {
+                    for(int px = t.x0; px < t.x1; px++) {
+                        sample_tree_linear(a, lookup, xl+px+0.5, yb+py+0.5, span.at(px-t.x0));
+                    }
+                    span.store(out_image, t.x0, py, t.x1-t.x0);
+                    continue;
+                }
+                for(int px = t.x0; px < t.x1; px++) {
+                    double x = xl+px+0.5;
+                    double y = yb+py+0.5;
+                    RGBA8 g_color(sample_tree(a, lookup, x, y));
+                    out_image.set_pixel(px, py, g_color[0], g_color[1], g_color[2], 255);
+                }
+            }
+            report.add(omp_get_wtime() - start);
+        }
+    }
+    report.stop();
+    if(a.stats) {
+        report.print(stderr, "tiles");
+    }
+}
+
+// index, when there is one, finds the leaves of the pixels for tree
+template <typename TREE, typename LEAF>
+void render_tree(const accelerated &a, const TREE* tree, 
+    const block_index<TREE, LEAF>* index, int xl, int yb, 
+    image<uint8_t, 4> &out_image) {
+    if(a.mode == e_render_mode::leaves && tree != nullptr) {
+        render_leaves<TREE, LEAF>(a, tree, xl, yb, out_image);
+        return;
+    }
+    std::vector<const LEAF*> leaves;
+    if(tree != nullptr) {
+        tree->get_leaves(leaves);
+    }
+    std::vector<tile> tiles = make_tiles(leaves, xl, yb, out_image.get_width(),
+        out_image.get_height(), a.tile);
+    if(index != nullptr) {
+        render_pixels(a, index, xl, yb, tiles, out_image);
+    } else {
+        render_pixels(a, tree, xl, yb, tiles, out_image);
+    }
+}
+
+void render_image(const accelerated &a, const viewport &v, 
+    image<uint8_t, 4> &out_image) {
     int xl, yb, xr, yt;
     std::tie(xl, yb) = v.bl();
     std::tie(xr, yt) = v.tr();
-    int width = xr - xl;
-    int height = yt - yb;
-    image<uint8_t, 4> out_image;
-    out_image.resize(width, height);
-    #pragma omp parallel for num_threads(a.threads)
-    for (int i = 1; i <= height; i++) {
-        for (int j = 1; j <= width; j++) {
-            double x = xl+j-0.5;
-            double y = yb+i-0.5;
-            RGBA8 g_color(sample(a, x, y));
-            out_image.set_pixel(j-1, i-1, g_color[0], g_color[1], g_color[2], 255);
+    out_image.resize(xr - xl, yt - yb);
+    if(a.cells != nullptr) {
+        render_tree<grid, leave_node>(a, a.cells, nullptr, xl, yb, out_image);
+    } else if(a.flat != nullptr) {
+        render_tree<flat_tree, flat_leaf>(a, a.flat, a.flat_index, xl, yb, out_image);
+    } else {
+        render_tree<tree_node, leave_node>(a, a.root, a.root_index, xl, yb, out_image);
+        if(a.stats && a.root != nullptr && a.config.build == e_build_mode::lazy) {
+            // what the samples made the tree expand
+            report_tree<tree_node, leave_node>(a.root, stderr);
         }
     }
+}
+
+void render(const accelerated &a, const window &w, const viewport &v,
+    FILE *out, const std::vector<std::string> &args) {
+    (void) args;
+    (void) w;
+    image<uint8_t, 4> out_image;
+    render_image(a, v, out_image);
     store_png<uint8_t>(out, out_image);
-    a.destroy();
+}
+
+// writes the image as rgb24, top row first
+static void store_raw(FILE *out, const image<uint8_t, 4> &in_image) {
+    int width = in_image.get_width();
+    int height = in_image.get_height();
+    std::vector<uint8_t> row(3*width);
+    for(int i = height-1; i >= 0; i--) {
+        for(int j = 0; j < width; j++) {
+            uint8_t alpha;
+            in_image.get_pixel(j, i, row[3*j], row[3*j+1], row[3*j+2], alpha);
+        }
+        fwrite(row.data(), 1, row.size(), out);
+    }
+}
+
+// splits a pattern with a single %d or %0Nd, and no other %, around
+// it, so frame names are formatted here and output is never read as a
+// format
+static bool split_pattern(const std::string &output, std::string &prefix,
+    int &width, std::string &suffix) {
+    size_t i = output.find('%');
+    size_t j = i + 1;
+    width = 0;
+    if(j < output.size() && output[j] == '0') {
+        for(j++; j < output.size() && j < i + 4 && isdigit(output[j]); j++) {
+            width = 10*width + (output[j] - '0');
+        }
+        if(width == 0) {
+            return false;
+        }
+    }
+    if(j >= output.size() || output[j] != 'd' ||
+        output.find('%', j) != std::string::npos) {
+        return false;
+    }
+    prefix = output.substr(0, i);
+    suffix = output.substr(j + 1);
+    return true;
+}
+
+static std::string open_error(const std::string &name) {
+    return name + ": " + strerror(errno);
+}
+
+std::string animate(const scene &c, const window &w, const viewport &v,
+    const std::vector<xform> &frames, const std::string &output,
+    const std::vector<std::string> &args) {
+    bool numbered = output.find('%') != std::string::npos;
+    std::string prefix, suffix;
+    int width = 0;
+    FILE *stream = nullptr;
+    if(numbered) {
+        if(!split_pattern(output, prefix, width, suffix)) {
+            return output + ": output pattern needs a single %d or %0Nd";
+        }
+    } else {
+        stream = output == std::string{"-"} ? stdout : fopen(output.c_str(), "wb");
+        if(stream == nullptr) {
+            return open_error(output);
+        }
+    }
+    image<uint8_t, 4> out_image;
+    accelerated a;
+    std::string error;
+    for(int f = 0; f < (int) frames.size() && error.empty(); f++) {
+        a = accelerate(c, w, v, frames[f], args, std::move(a));
+        render_image(a, v, out_image);
+        if(numbered) {
+            char number[32];
+            snprintf(number, sizeof(number), "%0*d", width, f);
+            std::string name = prefix + number + suffix;
+            FILE *out = fopen(name.c_str(), "wb");
+            if(out == nullptr) {
+                error = open_error(name);
+            } else {
+                store_png<uint8_t>(out, out_image);
+                fclose(out);
+            }
+        } else {
+            store_raw(stream, out_image);
+        }
+    }
+    if(stream != nullptr && stream != stdout) {
+        fclose(stream);
+    }
+    return error;
 }
 
 } // hadryan
@@ -127,29 +686,74 @@ void render(accelerated &a, const window &w, const viewport &v,
 // Lua version of the accelerate function.
 // Since there is no acceleration, we simply
 // and return the input scene unmodified.
+// An optional accelerated built before from the same scene can be
+// passed last, so a translated or rescaled build reuses its objects.
+// It shares them, and still renders as before.
 static int luaaccelerate(lua_State *L) {
+    hadryan::accelerated previous;
+    hadryan::accelerated* prev = &previous;
+    if(!lua_isnoneornil(L, 5)) {
+        prev = rvg_lua_check_pointer<hadryan::accelerated>(L, 5);
+    }
     rvg_lua_push<hadryan::accelerated>(L,
         hadryan::accelerate(
             rvg_lua_check<rvg::scene>(L, 1),
             rvg_lua_check<rvg::window>(L, 2),
             rvg_lua_check<rvg::viewport>(L, 3),
-            rvg_lua_optargs(L, 4)));
+            rvg::xform(),
+            rvg_lua_optargs(L, 4),
+            *prev));
     return 1;
 }
 
 // Lua version of render function
 static int luarender(lua_State *L) {
-    auto a = rvg_lua_check<hadryan::accelerated>(L, 1);
+    // by pointer, so the scene stays owned by the Lua object and is
+    // released by its __gc
+    auto a = rvg_lua_check_pointer<hadryan::accelerated>(L, 1);
     auto w = rvg_lua_check<rvg::window>(L, 2);
     auto v = rvg_lua_check<rvg::viewport>(L, 3);
     auto o = rvg_lua_optargs(L, 5);
-    hadryan::render(a, w, v, rvg_lua_check_file(L, 4), o);
+    hadryan::render(*a, w, v, rvg_lua_check_file(L, 4), o);
+    return 0;
+}
+
+// Lua version of the animate function, frames is a table of xforms
+static int luaanimate(lua_State *L) {
+    luaL_checktype(L, 4, LUA_TTABLE);
+    // lua_error leaves without unwinding, so the C++ objects live in a
+    // scope that ends before it, and only the message outlives them
+    bool failed;
+    {
+        std::vector<rvg::xform> frames;
+        int n = rvg_lua_len(L, 4);
+        for(int f = 1; f <= n; f++) {
+            lua_rawgeti(L, 4, f);
+            frames.push_back(rvg_lua_check<rvg::xform>(L, -1));
+            lua_pop(L, 1);
+        }
+        std::string error = hadryan::animate(
+            rvg_lua_check<rvg::scene>(L, 1),
+            rvg_lua_check<rvg::window>(L, 2),
+            rvg_lua_check<rvg::viewport>(L, 3),
+            frames,
+            luaL_checkstring(L, 5),
+            rvg_lua_optargs(L, 6));
+        failed = !error.empty();
+        if(failed) {
+            lua_pushstring(L, error.c_str());
+        }
+    }
+    if(failed) {
+        return lua_error(L);
+    }
     return 0;
 }
 
 // List of Lua functions exported into driver table
 static const luaL_Reg modpngpng[] = {
     {"render", luarender },
+    {"animate", luaanimate },
     {"accelerate", luaaccelerate },
     {NULL, NULL}
 };
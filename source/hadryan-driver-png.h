@@ -2,10 +2,12 @@
 #define HADRYAN_DRIVER_PNG_H
 
 #include <vector>
+#include <string>
 
 #include "rvg-viewport.h"
 #include "rvg-scene.h"
 #include "rvg-window.h"
+#include "rvg-xform.h"
 
 #include "hadryan-accelerated.h"
 
@@ -13,13 +15,38 @@ using namespace rvg;
 
 namespace hadryan {
     
-const accelerated accelerate(const scene &c, const window &w,
-    const viewport &v);
+accelerated accelerate(const scene &c, const window &w,
+    const viewport &v, const std::vector<std::string> &args =
+        std::vector<std::string>());
+
+accelerated accelerate(const scene &c, const window &w,
+    const viewport &v, const xform &frame_xf, 
+    const std::vector<std::string> &args = std::vector<std::string>());
+
+// previous keeps its objects valid, and they are copied before being
+// moved; given as an rvalue, it gives them up to be moved in place
+accelerated accelerate(const scene &c, const window &w,
+    const viewport &v, const xform &frame_xf, 
+    const std::vector<std::string> &args, accelerated &previous);
+
+accelerated accelerate(const scene &c, const window &w,
+    const viewport &v, const xform &frame_xf, 
+    const std::vector<std::string> &args, accelerated &&previous);
 
 void render(const accelerated &a, const window &w, const viewport &v,
     FILE *out, const std::vector<std::string> &args =
         std::vector<std::string>());
 
+// renders one frame per xform, writing them to numbered png files when
+// output is a pattern such as out-%05d.png, with a single %d or %0Nd,
+// or otherwise as a raw rgb24 stream to the output file ("-" for
+// stdout). Stops at the first file it cannot open, giving an error
+// that names it, or before any frame when output is not such a
+// pattern, and gives an empty string once every frame is written.
+std::string animate(const scene &c, const window &w, const viewport &v,
+    const std::vector<xform> &frames, const std::string &output,
+    const std::vector<std::string> &args = std::vector<std::string>());
+
 } // hadryan
 
 #endif // HADRYAN_DRIVER_PNG_H
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "hadryan-flat-tree.h"
+
+#include "hadryan-tree-node.h"
+#include "hadryan-winding.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+flat_object::flat_object(const node_object &nobj, uint32_t ref_begin)
+    : m_refs(nullptr)
+    , m_ref_begin(ref_begin)
+    , m_n_refs(nobj.get_size())
+    , m_store(nullptr)
+    , m_ranges()
+    , m_w_increment(nobj.get_increment())
+    , m_ptr(nobj.m_ptr)
+{}
+
+bool flat_object::hit(const double x, const double y) const {
+    if(m_store != nullptr) {
+        return m_store->hit(m_ptr, m_w_increment, m_ranges, x, y);
+    }
+    return winding_hit(m_ptr, m_w_increment, m_refs, m_n_refs, x, y);
+}
+
+uint64_t flat_object::hit_lanes(const sample_lanes &lanes, uint64_t open,
+    const lane_kernels &k) const {
+    if(m_store != nullptr) {
+        return m_store->hit_lanes(m_ptr, m_w_increment, m_ranges, lanes, open, k);
+    }
+    return winding_lanes(m_ptr, m_w_increment, m_refs, m_n_refs, lanes, open, k);
+}
+
+bool flat_object::hit_constant(const bouding_box &area) const {
+    return winding_constant(m_ptr, m_refs, m_n_refs, area);
+}
+
+bool flat_object::cover(const bouding_box &area, double &fraction) const {
+    return winding_cover(m_ptr, m_w_increment, m_refs, m_n_refs, area, fraction);
+}
+
+flat_leaf::flat_leaf(const R2 &p0, const R2 &p1, uint32_t obj_begin, 
+    uint32_t n_objects, bool solid)
+    : m_p0(p0)
+    , m_p1(p1)
+    , m_objects(nullptr)
+    , m_obj_begin(obj_begin)
+    , m_n_objects(n_objects)
+    , m_solid(solid)
+{}
+
+flat_tree::flat_tree(const tree_node* root, bool soa, bool single) 
+    : m_p0(root->get_p0())
+    , m_p1(root->get_p1())
+    , m_nodes(1)
+    , m_soa(soa) {
+    root->flatten(*this, 0);
+    m_nodes.shrink_to_fit();
+    m_leaves.shrink_to_fit();
+    m_objects.shrink_to_fit();
+    m_refs.shrink_to_fit();
+    m_store.finish(single);
+    // arrays will not move anymore, so ranges can point into them
+    for(auto &fobj : m_objects) {
+        fobj.bind(m_refs.data(), m_soa ? &m_store : nullptr);
+    }
+    for(auto &leaf : m_leaves) {
+        leaf.bind(m_objects.data());
+    }
+}
+
+int flat_tree::add_children(int index, const R2 &pc) {
+    int first = m_nodes.size();
+    m_nodes[index].cx = pc[0];
+    m_nodes[index].cy = pc[1];
+    m_nodes[index].next = first;
+    m_nodes.resize(first + 4);
+    return first;
+}
+
+void flat_tree::add_leaf(int index, const R2 &p0, const R2 &p1, bool solid,
+    range<const node_object> objects) {
+    m_nodes[index].cx = 0;
+    m_nodes[index].cy = 0;
+    m_nodes[index].next = ~((int32_t) m_leaves.size());
+    m_leaves.emplace_back(p0, p1, m_objects.size(), objects.size(), solid);
+    for(auto &nobj : objects) {
+        m_objects.emplace_back(nobj, m_refs.size());
+        m_refs.insert(m_refs.end(), nobj.get_refs().begin(), nobj.get_refs().end());
+        if(m_soa) {
+            segment_store::ranges ranges = m_store.begin_ranges();
+            for(auto ref : nobj.get_refs()) {
+                m_store.add(*nobj.get_segment(ref));
+            }
+            for(auto ref : nobj.get_refs()) {
+                if(is_shortcut(ref)) {
+                    m_store.add_shortcut(*nobj.get_segment(ref));
+                }
+            }
+            m_store.end_ranges(ranges);
+            m_objects.back().set_ranges(ranges);
+        }
+    }
+}
+
+void flat_tree::get_leaves(std::vector<const flat_leaf*> &leaves) const {
+    for(auto &leaf : m_leaves) {
+        leaves.push_back(&leaf);
+    }
+}
+
+// bytes of the node, leaf, object and ref arrays, without the
+// segment_store
+size_t flat_tree::get_reserved() const {
+    return m_nodes.capacity()*sizeof(node) + m_leaves.capacity()*sizeof(flat_leaf)
+        + m_objects.capacity()*sizeof(flat_object)
+        + m_refs.capacity()*sizeof(segment_ref) + m_store.get_reserved();
+}
+
+} // hadryan
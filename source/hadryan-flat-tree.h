@@ -0,0 +1,162 @@
+#ifndef HADRYAN_FLAT_TREE_H
+#define HADRYAN_FLAT_TREE_H
+
+#include <vector>
+#include <cstdint>
+
+#include "rvg-rgba.h"
+
+#include "hadryan-bouding-box.h"
+#include "hadryan-path-segment.h"
+#include "hadryan-scene-object.h"
+#include "hadryan-node-object.h"
+#include "hadryan-segment-store.h"
+#include "hadryan-range.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+class tree_node;
+
+// node_object of a flat_tree leaf, its segment_refs are a range of
+// the tree's ref array
+class flat_object {
+    const segment_ref* m_refs;
+    uint32_t m_ref_begin;
+    uint32_t m_n_refs;
+    // copies of the segments, when the tree keeps a segment_store
+    const segment_store* m_store;
+    segment_store::ranges m_ranges;
+public:
+    int m_w_increment;
+    const scene_object* m_ptr;
+public:
+    flat_object(const node_object &nobj, uint32_t ref_begin);
+    bool hit(const double x, const double y) const;
+    uint64_t hit_lanes(const sample_lanes &lanes, uint64_t open,
+        const lane_kernels &k) const;
+    bool hit_constant(const bouding_box &area) const;
+    bool cover(const bouding_box &area, double &fraction) const;
+    RGBA8 get_color(const double x, const double y) const;
+    int get_size() const;
+    void set_ranges(const segment_store::ranges &ranges);
+    void bind(const segment_ref* refs, const segment_store* store);
+};
+
+class flat_leaf {
+    R2 m_p0;
+    R2 m_p1;
+    const flat_object* m_objects;
+    uint32_t m_obj_begin;
+    uint32_t m_n_objects;
+    bool m_solid;
+public:
+    typedef range<const flat_object> object_range;
+    flat_leaf(const R2 &p0, const R2 &p1, uint32_t obj_begin, uint32_t n_objects, 
+        bool solid);
+    object_range get_objects() const;
+    bool is_solid() const;
+    bool hit_constant(const bouding_box &area) const;
+    const R2& get_p0() const;
+    const R2& get_p1() const;
+    void bind(const flat_object* objects);
+};
+
+// The shortcut tree compacted into contiguous arrays. Children of an
+// intern node are four consecutive node records in Morton order
+// (bl, br, tl, tr), and the tree is laid out depth first, so leaves
+// close in space are close in memory. With soa, the segments of each
+// leaf are also copied into a segment_store, which the winding tests
+// use instead of the virtual segments, with float columns for single
+// precision lanes when single is set.
+class flat_tree {
+public:
+    struct node {
+        int32_t cx;
+        int32_t cy;
+        int32_t next; // first child if >= 0, ~leaf otherwise
+    };
+private:
+    R2 m_p0;
+    R2 m_p1;
+    std::vector<node> m_nodes;
+    std::vector<flat_leaf> m_leaves;
+    std::vector<flat_object> m_objects;
+    std::vector<segment_ref> m_refs;
+    segment_store m_store;
+    bool m_soa;
+
+    flat_tree(const flat_tree &rhs) = delete;
+    flat_tree& operator=(const flat_tree &rhs) = delete;
+public:
+    flat_tree(const tree_node* root, bool soa = false, bool single = false);
+    int add_children(int index, const R2 &pc);
+    void add_leaf(int index, const R2 &p0, const R2 &p1, bool solid,
+        range<const node_object> objects);
+    const flat_leaf* get_node_of(const double &x, const double &y) const;
+    void get_leaves(std::vector<const flat_leaf*> &leaves) const;
+    size_t get_reserved() const;
+};
+
+inline RGBA8 flat_object::get_color(const double x, const double y) const {
+    return m_ptr->get_color(x, y);
+}
+
+inline int flat_object::get_size() const {
+    return m_n_refs;
+}
+
+inline void flat_object::set_ranges(const segment_store::ranges &ranges) {
+    m_ranges = ranges;
+}
+
+inline void flat_object::bind(const segment_ref* refs, 
+    const segment_store* store) {
+    m_refs = refs + m_ref_begin;
+    m_store = store;
+}
+
+inline flat_leaf::object_range flat_leaf::get_objects() const {
+    return object_range(m_objects, m_objects+m_n_objects);
+}
+
+inline bool flat_leaf::is_solid() const {
+    return m_solid;
+}
+
+inline bool flat_leaf::hit_constant(const bouding_box &area) const {
+    for(auto &fobj : get_objects()) {
+        if(!fobj.hit_constant(area)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline const R2& flat_leaf::get_p0() const {
+    return m_p0;
+}
+
+inline const R2& flat_leaf::get_p1() const {
+    return m_p1;
+}
+
+inline void flat_leaf::bind(const flat_object* objects) {
+    m_objects = objects + m_obj_begin;
+}
+
+inline const flat_leaf* flat_tree::get_node_of(const double &x, const double &y) const {
+    if(!(x >= m_p0[0] && x < m_p1[0] && y >= m_p0[1] && y < m_p1[1])) {
+        return nullptr;
+    }
+    const node* nod = &m_nodes[0];
+    while(nod->next >= 0) {
+        nod = &m_nodes[nod->next + (x >= nod->cx) + 2*(y >= nod->cy)];
+    }
+    return &m_leaves[~nod->next];
+}
+
+} // hadryan
+
+#endif // HADRYAN_FLAT_TREE_H
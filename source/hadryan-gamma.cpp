@@ -0,0 +1,79 @@
+#include "hadryan-gamma.h"
+
+#include <cstring>
+
+#include "hadryan-simd-target.h"
+
+#ifdef HADRYAN_X86
+#include <immintrin.h>
+#endif
+
+namespace hadryan {
+
+#ifdef HADRYAN_X86
+
+// clamps, scales and rounds like encode_scalar, then looks the indices
+// up with a gather and narrows the bytes it reads to the first one
+HADRYAN_AVX2 static void encode_avx2(const float* linear, int n, uint8_t* out) {
+    const int* lut = reinterpret_cast<const int*>(gamma_lut::get_encode());
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 scale = _mm256_set1_ps(gamma_lut::encode_size-1);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i low = _mm256_set1_epi32(0xff);
+    int i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256 l = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(linear + i), zero), one);
+        __m256i idx = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(l, scale), half));
+        __m256i c = _mm256_and_si256(_mm256_i32gather_epi32(lut, idx, 1), low);
+        // each 128 bit half packs into its own first 4 bytes
+        c = _mm256_packus_epi16(_mm256_packus_epi32(c, c), c);
+        uint32_t lo = _mm_cvtsi128_si32(_mm256_castsi256_si128(c));
+        uint32_t hi = _mm_cvtsi128_si32(_mm256_extracti128_si256(c, 1));
+        memcpy(out + i, &lo, 4);
+        memcpy(out + i + 4, &hi, 4);
+    }
+    gamma_lut::encode_scalar(linear + i, n - i, out + i);
+}
+
+// the same in 16 lanes, with the mask forms of every intrinsic whose
+// plain form starts from an undefined register, which GCC 12 reports
+// as maybe uninitialized
+HADRYAN_AVX512 static void encode_avx512(const float* linear, int n, uint8_t* out) {
+    const int* lut = reinterpret_cast<const int*>(gamma_lut::get_encode());
+    const __mmask16 all = 0xffff;
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.f);
+    const __m512 scale = _mm512_set1_ps(gamma_lut::encode_size-1);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512i none = _mm512_setzero_si512();
+    int i = 0;
+    for(; i + 16 <= n; i += 16) {
+        __m512 l = _mm512_maskz_min_ps(all,
+            _mm512_maskz_max_ps(all, _mm512_loadu_ps(linear + i), zero), one);
+        __m512i idx = _mm512_maskz_cvttps_epi32(all,
+            _mm512_add_ps(_mm512_mul_ps(l, scale), half));
+        __m512i c = _mm512_mask_i32gather_epi32(none, all, idx, lut, 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+            _mm512_maskz_cvtepi32_epi8(all, c));
+    }
+    gamma_lut::encode_scalar(linear + i, n - i, out + i);
+}
+
+#endif
+
+void gamma_lut::encode(const float* linear, int n, uint8_t* out) {
+#ifdef HADRYAN_X86
+    if(cpu_has_avx512()) {
+        encode_avx512(linear, n, out);
+        return;
+    }
+    if(cpu_has_avx2()) {
+        encode_avx2(linear, n, out);
+        return;
+    }
+#endif
+    encode_scalar(linear, n, out);
+}
+
+} // hadryan
@@ -0,0 +1,63 @@
+#ifndef HADRYAN_GAMMA_H
+#define HADRYAN_GAMMA_H
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+namespace hadryan {
+
+class gamma_lut {
+
+public:
+
+    static constexpr int encode_bits = 12;
+    static constexpr int encode_size = 1 << encode_bits;
+
+    // sRGB 8-bit value to linear light in [0, 1]
+    static const float* get_decode() {
+        static const struct table {
+            float v[256];
+            table() {
+                for(int i = 0; i < 256; i++) {
+                    double c = i/255.0;
+                    v[i] = (c <= 0.04045) ? c/12.92 : std::pow((c+0.055)/1.055, 2.4);
+                }
+            }
+        } decode;
+        return decode.v;
+    }
+
+    // linear light quantized to encode_bits to sRGB 8-bit value. The
+    // vector encoders gather 4 bytes at an index, so 3 more follow.
+    static const uint8_t* get_encode() {
+        static const struct table {
+            uint8_t v[encode_size + 3] = {};
+            table() {
+                for(int i = 0; i < encode_size; i++) {
+                    double l = i/(double)(encode_size-1);
+                    double c = (l <= 0.0031308) ? 12.92*l : 1.055*std::pow(l, 1/2.4)-0.055;
+                    v[i] = (uint8_t) std::lround(255.0*c);
+                }
+            }
+        } encode;
+        return encode.v;
+    }
+
+    // encodes n linear values in [0, 1] into sRGB 8-bit values, with
+    // the widest vector instructions the processor supports
+    static void encode(const float* linear, int n, uint8_t* out);
+
+    // the same in plain C++, which the others must match
+    static void encode_scalar(const float* linear, int n, uint8_t* out) {
+        constexpr float scale = encode_size-1;
+        const uint8_t* lut = get_encode();
+        for(int i = 0; i < n; i++) {
+            out[i] = lut[(int) (std::min(std::max(linear[i], 0.f), 1.f)*scale + 0.5f)];
+        }
+    }
+};
+
+} // hadryan
+
+#endif // HADRYAN_GAMMA_H
@@ -0,0 +1,143 @@
+#include "hadryan-grid.h"
+
+#include "hadryan-quad-tree-auxiliar.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+grid::grid(const leave_node* root, int size, int threads, arena &a)
+    : m_x0((int) root->get_p0()[0])
+    , m_y0((int) root->get_p0()[1])
+    , m_x1((int) root->get_p1()[0])
+    , m_y1((int) root->get_p1()[1])
+    , m_size(std::max(size, 1))
+    , m_nx(std::max((m_x1-m_x0+m_size-1)/m_size, 1))
+    , m_ny(std::max((m_y1-m_y0+m_size-1)/m_size, 1))
+    , m_cells(m_nx*m_ny, nullptr) {
+    // rows share nothing but the root, so each is built on its own
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+    for(int row = 0; row < m_ny; row++) {
+        build_row(root, row, a);
+    }
+}
+
+// Segments per cell that keep the cost of a sample close to that of a
+// tree leaf, while the build stays linear in the number of cells.
+int grid::auto_size(const leave_node* root) {
+    constexpr double segments_per_cell = 2.0;
+    long n_segments = 0;
+    for(auto &nobj : root->get_objects()) {
+        n_segments += nobj.get_size();
+    }
+    double width = root->get_p1()[0] - root->get_p0()[0];
+    double height = root->get_p1()[1] - root->get_p0()[1];
+    if(n_segments == 0) {
+        return std::max((int) std::max(width, height), 1);
+    }
+    double size = std::sqrt(width*height*segments_per_cell/n_segments);
+    return (int) std::min(std::max(std::round(size), 2.0), std::max(width, height));
+}
+
+// Clips the root objects to the cells of a row, as a split clips them
+// to the four quadrants. The increment of a cell is the winding number
+// the root gives to its bottom right corner, and every corner of the
+// row is on the same horizontal, so each segment adds its direction to
+// the whole run of corners on its left at once.
+void grid::build_row(const leave_node* root, int row, arena &a) {
+    static thread_local std::vector<leave_builder> cells;
+    static thread_local std::vector<node_object_builder> objs;
+    static thread_local std::vector<int> steps;
+    cells.resize(m_nx);
+    objs.resize(m_nx);
+    steps.resize(m_nx+1);
+    int y0 = m_y0 + row*m_size;
+    int y1 = std::min(y0 + m_size, m_y1);
+    for(int c = 0; c < m_nx; c++) {
+        cells[c].reset(make_R2(m_x0 + c*m_size, y0), make_R2(get_corner(c), y1));
+    }
+    // column holding x, clamped to the grid
+    auto column_of = [this](double x) {
+        int c = (int) std::floor((x - m_x0)/m_size);
+        return std::min(std::max(c, 0), m_nx-1);
+    };
+    for(auto &nobj : root->get_objects()) {
+        const bouding_box &obj_bbox = nobj.m_ptr->get_bbox();
+        if(obj_bbox.get_p1()[1] < y0 || obj_bbox.get_p0()[1] > y1) {
+            continue;
+        }
+        int c0 = column_of(obj_bbox.get_p0()[0]);
+        int c1 = column_of(obj_bbox.get_p1()[0]);
+        for(int c = c0; c <= c1; c++) {
+            objs[c].reset(nobj.m_ptr, nobj.m_w_increment);
+            steps[c] = 0;
+        }
+        steps[c1+1] = 0;
+        for(auto ref : nobj.get_refs()) {
+            uint32_t index = segment_index(ref);
+            const path_segment* seg = nobj.get_segment(ref);
+            const R2 &b0 = seg->m_bbox.get_p0();
+            const R2 &b1 = seg->m_bbox.get_p1();
+            if(b1[1] >= y0 && b0[1] <= y1) {
+                int s1 = std::min(column_of(b1[0]), c1);
+                for(int c = std::max(column_of(b0[0]), c0); c <= s1; c++) {
+                    int x0 = m_x0 + c*m_size;
+                    int x1 = get_corner(c);
+                    bool hit_right = hit_v_bound(x1, y0, y1, seg);
+                    if(hit_right || hit_h_bound(y0, x0, x1, seg)
+                        || hit_v_bound(x0, y0, y1, seg) || hit_h_bound(y1, x0, x1, seg)
+                        || totally_inside(x0, x1, y0, y1, seg)) {
+                        objs[c].add_segment(index, hit_right);
+                    }
+                }
+            }
+            if(y0 >= b0[1] && y0 < b1[1]) {
+                // corners on the left of the bounding box all see the segment
+                int left = std::max(std::min(column_of(b0[0]), c1+1), c0);
+                while(left > c0 && get_corner(left-1) > b0[0]) {
+                    left--;
+                }
+                while(left <= c1 && get_corner(left) <= b0[0]) {
+                    left++;
+                }
+                steps[c0] += seg->get_dir();
+                steps[left] -= seg->get_dir();
+                for(int c = left; c <= c1 && get_corner(c) <= b1[0]; c++) {
+                    if(seg->intersect(get_corner(c), y0)) {
+                        objs[c].increment(seg->get_dir());
+                    }
+                }
+            }
+            if(is_shortcut(ref) && seg->intersect_shortcut(m_x0, y0)) {
+                // the shortcut runs up from the right end of the segment
+                double r = seg->right()[0];
+                int end = std::max(std::min(column_of(r), c1+1), c0);
+                while(end > c0 && get_corner(end-1) >= r) {
+                    end--;
+                }
+                while(end <= c1 && get_corner(end) < r) {
+                    end++;
+                }
+                steps[c0] += seg->get_sh_dir();
+                steps[end] -= seg->get_sh_dir();
+            }
+        }
+        int sum = 0;
+        for(int c = c0; c <= c1; c++) {
+            sum += steps[c];
+            objs[c].increment(sum);
+            if(objs[c].get_size() || objs[c].get_increment() != 0) {
+                cells[c].add_node_object(objs[c], a);
+            }
+        }
+    }
+    for(int c = 0; c < m_nx; c++) {
+        m_cells[row*m_nx + c] = cells[c].build(a);
+    }
+}
+
+void grid::get_leaves(std::vector<const leave_node*> &leaves) const {
+    leaves.insert(leaves.end(), m_cells.begin(), m_cells.end());
+}
+
+} // hadryan
@@ -0,0 +1,73 @@
+#ifndef HADRYAN_GRID_H
+#define HADRYAN_GRID_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "hadryan-leave-node.h"
+#include "hadryan-arena.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+// Regular grid of size x size pixel cells over the root cell, the
+// alternative to the shortcut tree. Each cell is a leave_node with
+// the winding increment at its bottom right corner and the shortcuts
+// of the segments leaving through its right side, so it is sampled
+// like a tree leaf, but found with a division instead of a descent.
+class grid {
+    int m_x0;
+    int m_y0;
+    int m_x1;
+    int m_y1;
+    int m_size;
+    int m_nx;
+    int m_ny;
+    std::vector<const leave_node*> m_cells; // in the arena, bottom row first
+
+    grid(const grid &rhs) = delete;
+    grid& operator=(const grid &rhs) = delete;
+    int get_corner(int column) const;
+    void build_row(const leave_node* root, int row, arena &a);
+public:
+    grid(const leave_node* root, int size, int threads, arena &a);
+    static int auto_size(const leave_node* root);
+    const leave_node* get_node_of(const double &x, const double &y) const;
+    void get_leaves(std::vector<const leave_node*> &leaves) const;
+    int get_size() const;
+    int get_columns() const;
+    int get_rows() const;
+};
+
+// x of the right side of the cells in column
+inline int grid::get_corner(int column) const {
+    return std::min(m_x0 + (column+1)*m_size, m_x1);
+}
+
+inline const leave_node* grid::get_node_of(const double &x, const double &y) const {
+    if(!(x >= m_x0 && x < m_x1 && y >= m_y0 && y < m_y1)) {
+        return nullptr;
+    }
+    // cell sides are on integer coordinates
+    int column = ((int) std::floor(x) - m_x0)/m_size;
+    int row = ((int) std::floor(y) - m_y0)/m_size;
+    return m_cells[row*m_nx + column];
+}
+
+inline int grid::get_size() const {
+    return m_size;
+}
+
+inline int grid::get_columns() const {
+    return m_nx;
+}
+
+inline int grid::get_rows() const {
+    return m_ny;
+}
+
+} // hadryan
+
+#endif // HADRYAN_GRID_H
@@ -1,5 +1,7 @@
 #include "hadryan-intern-node.h"
 
+#include "hadryan-flat-tree.h"
+
 namespace hadryan {
 
 intern_node::intern_node(const R2 &p0, const R2 &p1, tree_node* tr,
@@ -11,30 +13,19 @@ intern_node::intern_node(const R2 &p0, const R2 &p1, tree_node* tr,
     , m_br(br) 
 {}
 
-void intern_node::destroy() {
-    m_tr->destroy();
-    m_tl->destroy();
-    m_bl->destroy();
-    m_br->destroy();
-    delete m_tr;
-    delete m_tl;
-    delete m_bl;
-    delete m_br;
-}
-
 const leave_node* intern_node::get_node_of(const double &x, const double &y) const {
-    if(!(x >= m_p0[0] && x < m_p1[0]
-        && y >= m_p0[1] && y < m_p1[1])) {
+    if(!is_in_cell(x, y)) {
         return nullptr;
     }
-    if(x >= m_p0[0] && x < m_pc[0]) { // left side
-        if(y >= m_p0[1] && y < m_pc[1]) { // bottom side
+    R2 pc = get_pc();
+    if(x < pc[0]) { // left side
+        if(y < pc[1]) { // bottom side
             return m_bl->get_node_of(x, y); 
         } else { // top side
             return m_tl->get_node_of(x, y);
         }
     } else { // right side
-        if(y >= m_p0[1] && y < m_pc[1]) { // bottom side
+        if(y < pc[1]) { // bottom side
             return m_br->get_node_of(x, y);
         } else { // top side
             return m_tr->get_node_of(x, y);
@@ -42,4 +33,19 @@ const leave_node* intern_node::get_node_of(const double &x, const double &y) con
     }
 }
 
+void intern_node::get_leaves(std::vector<const leave_node*> &leaves) const {
+    m_tr->get_leaves(leaves);
+    m_tl->get_leaves(leaves);
+    m_bl->get_leaves(leaves);
+    m_br->get_leaves(leaves);
+}
+
+void intern_node::flatten(flat_tree &tree, int index) const {
+    int first = tree.add_children(index, get_pc());
+    m_bl->flatten(tree, first);
+    m_br->flatten(tree, first+1);
+    m_tl->flatten(tree, first+2);
+    m_tr->flatten(tree, first+3);
+}
+
 } // hadryan
\ No newline at end of file
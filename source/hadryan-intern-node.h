@@ -15,8 +15,9 @@ class intern_node : public tree_node {
 public:
     intern_node(const R2 &p0, const R2 &p1, tree_node* tr,
             tree_node* tl, tree_node* bl, tree_node* br);
-    void destroy();
     const leave_node* get_node_of(const double &x, const double &y) const;
+    void get_leaves(std::vector<const leave_node*> &leaves) const;
+    void flatten(flat_tree &tree, int index) const;
 };
 
 } // hadryan
@@ -0,0 +1,48 @@
+#include "hadryan-lazy-node.h"
+
+#include "hadryan-leave-node.h"
+#include "hadryan-intern-node.h"
+
+namespace hadryan {
+
+lazy_node::lazy_node(const leave_node* leave, const tree_config &config, 
+    arena &a, int depth)
+    : tree_node(leave->get_p0(), leave->get_p1())
+    , m_config(config)
+    , m_arena(a)
+    , m_depth(depth)
+    , m_leave(leave)
+    , m_node(nullptr)
+{}
+
+// the unsplit leave_node stays in the arena until the tree goes
+void lazy_node::expand() const {
+    leave_node* children[4];
+    if(!m_leave->split(m_config, m_arena, m_depth, children)) {
+        m_node = m_leave;
+        return;
+    }
+    m_node = m_arena.make<intern_node>(get_p0(), get_p1(), 
+        m_arena.make<lazy_node>(children[0], m_config, m_arena, m_depth+1),
+        m_arena.make<lazy_node>(children[1], m_config, m_arena, m_depth+1),
+        m_arena.make<lazy_node>(children[2], m_config, m_arena, m_depth+1),
+        m_arena.make<lazy_node>(children[3], m_config, m_arena, m_depth+1));
+}
+
+// leaves expanded so far, with the cells nobody sampled yet reported
+// whole; must not run while render threads are expanding the tree
+void lazy_node::get_leaves(std::vector<const leave_node*> &leaves) const {
+    if(m_node != nullptr) {
+        m_node->get_leaves(leaves);
+    } else {
+        leaves.push_back(m_leave);
+    }
+}
+
+// a flat_tree needs the whole tree
+void lazy_node::flatten(flat_tree &tree, int index) const {
+    std::call_once(m_once, &lazy_node::expand, this);
+    m_node->flatten(tree, index);
+}
+
+} // hadryan
@@ -0,0 +1,41 @@
+#ifndef HADRYAN_LAZY_NODE_H
+#define HADRYAN_LAZY_NODE_H
+
+#include <mutex>
+
+#include "hadryan-tree-node.h"
+#include "hadryan-tree-config.h"
+#include "hadryan-arena.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+// Leaf of a lazily built tree. It keeps the leave_node with its
+// objects and splits it one level the first time a sample lands in
+// it, into an intern_node with four lazy children. Render threads
+// that reach the node at the same time wait for a single expansion.
+class lazy_node : public tree_node {
+    const tree_config m_config;
+    arena &m_arena;
+    const int m_depth;
+    mutable std::once_flag m_once;
+    const leave_node* m_leave;
+    mutable const tree_node* m_node; // expansion, m_leave if it stays a leaf
+    void expand() const;
+public:
+    lazy_node(const leave_node* leave, const tree_config &config, arena &a, 
+        int depth = 0);
+    const leave_node* get_node_of(const double &x, const double &y) const;
+    void get_leaves(std::vector<const leave_node*> &leaves) const;
+    void flatten(flat_tree &tree, int index) const;
+};
+
+inline const leave_node* lazy_node::get_node_of(const double &x, const double &y) const {
+    std::call_once(m_once, &lazy_node::expand, this);
+    return m_node->get_node_of(x, y);
+}
+
+} // hadryan
+
+#endif // HADRYAN_LAZY_NODE_H
@@ -1,15 +1,20 @@
 #include "hadryan-leave-node.h"
 
 #include "hadryan-intern-node.h"
+#include "hadryan-flat-tree.h"
 #include "hadryan-quad-tree-auxiliar.h"
 
 using namespace rvg;
 
 namespace hadryan {
 
-leave_node::leave_node(const R2 &p0, const R2 &p1)
+leave_node::leave_node(const R2 &p0, const R2 &p1, const node_object* objects,
+    int n_objects, int n_segments, bool solid)
     : tree_node(p0, p1)
-    , m_n_segments(0)
+    , m_objects(objects)
+    , m_n_objects(n_objects)
+    , m_n_segments(n_segments)
+    , m_solid(solid)
 {}
 
 const leave_node* leave_node::get_node_of(const double &x, const double &y) const {
@@ -18,52 +23,101 @@ const leave_node* leave_node::get_node_of(const double &x, const double &y) cons
     return this;
 }
 
-tree_node* leave_node::subdivide(int depth) {
-    if(depth >= max_depth || m_n_segments < min_segments) {
-        return this;
+void leave_node::get_leaves(std::vector<const leave_node*> &leaves) const {
+    leaves.push_back(this);
+}
+
+void leave_node::flatten(flat_tree &tree, int index) const {
+    tree.add_leaf(index, get_p0(), get_p1(), m_solid, get_objects());
+}
+
+// Expected cost of a sample in the cell, in units of a linear
+// implicit test. Every segment pays its bounding box test, and its
+// implicit test when the sample falls in the bounding box, which
+// happens in proportion to the area it covers in the cell.
+double leave_node::sample_cost() const {
+    constexpr double object_cost = 1.0;
+    constexpr double bbox_cost = 0.5;
+    constexpr double shortcut_cost = 0.5;
+    double area = get_area();
+    bouding_box bbox = get_bbox();
+    double cost = 0.0;
+    for(auto &nobj : get_objects()) {
+        int n_shortcuts = 0;
+        for(auto ref : nobj.get_refs()) {
+            n_shortcuts += is_shortcut(ref);
+        }
+        cost += object_cost + shortcut_cost*n_shortcuts;
+        for(auto ref : nobj.get_refs()) {
+            if(is_shortcut(ref)) {
+                continue;
+            }
+            const path_segment* seg = nobj.get_segment(ref);
+            cost += bbox_cost;
+            if(area > 0) {
+                cost += seg->get_cost()*bbox.overlap(seg->m_bbox)/area;
+            }
+        }
     }
-    auto tr = new leave_node(m_pc, m_p1);
-    auto tl = new leave_node(make_R2(m_p0[0],m_pc[1]), make_R2(m_pc[0],m_p1[1]));
-    auto bl = new leave_node(m_p0, m_pc);
-    auto br = new leave_node(make_R2(m_pc[0],m_p0[1]), make_R2(m_p1[0],m_pc[1]));
-    for(auto &nobj : m_objects) {
-        node_object tr_obj(nobj.m_ptr);
-        node_object tl_obj(nobj.m_ptr);
-        node_object bl_obj(nobj.m_ptr);
-        node_object br_obj(nobj.m_ptr);
-        tr_obj.m_w_increment = nobj.m_w_increment;
-        tl_obj.m_w_increment = nobj.m_w_increment;
-        bl_obj.m_w_increment = nobj.m_w_increment;
-        br_obj.m_w_increment = nobj.m_w_increment;
-        auto all_seg(nobj.get_all_segments());
-        for(auto &seg : all_seg) {
-            bool hit_tr_righ = hit_v_bound(m_p1[0], m_pc[1], m_p1[1], seg);
-            bool hit_br_righ = hit_v_bound(m_p1[0], m_p0[1], m_pc[1], seg);
-            bool hit_br_down = hit_h_bound(m_p0[1], m_pc[0], m_p1[0], seg);
-            bool hit_bl_down = hit_h_bound(m_p0[1], m_p0[0], m_pc[0], seg);
-            bool hit_bl_left = hit_v_bound(m_p0[0], m_p0[1], m_pc[1], seg);
-            bool hit_tl_left = hit_v_bound(m_p0[0], m_pc[1], m_p1[1], seg);
-            bool hit_tl_up   = hit_h_bound(m_p1[1], m_p0[0], m_pc[0], seg);
-            bool hit_tr_up   = hit_h_bound(m_p1[1], m_pc[0], m_p1[0], seg);
-            bool hit_tl_tr   = hit_v_bound(m_pc[0], m_pc[1], m_p1[1], seg);
-            bool hit_bl_tl   = hit_h_bound(m_pc[1], m_p0[0], m_pc[0], seg);
-            bool hit_bl_br   = hit_v_bound(m_pc[0], m_p0[1], m_pc[1], seg);
-            bool hit_br_tr   = hit_h_bound(m_pc[1], m_pc[0], m_p1[0], seg);
-            bool hit_c_inf   = seg->intersect(m_pc[0], m_pc[1]);
-            bool hit_cr_inf  = seg->intersect(m_p1[0], m_pc[1]);
-            bool hit_dc_inf  = seg->intersect(m_pc[0], m_p0[1]);
-            bool hit_br_inf  = seg->intersect(m_p1[0], m_p0[1]);
-            if(totally_inside(tr->m_p0, tr->m_p1, seg) || hit_tr_righ || hit_tr_up || hit_tl_tr || hit_br_tr) {
-                tr_obj.add_segment(seg, hit_tr_righ);
-            }
-            if(totally_inside(tl->m_p0, tl->m_p1, seg) || hit_tl_left || hit_tl_tr || hit_tl_up || hit_bl_tl) {
-                tl_obj.add_segment(seg, hit_tl_tr);
-            }
-            if(totally_inside(bl->m_p0, bl->m_p1, seg) || hit_bl_br || hit_bl_down || hit_bl_left || hit_bl_tl) {
-                bl_obj.add_segment(seg, hit_bl_br);
-            }
-            if(totally_inside(br->m_p0, br->m_p1, seg) || hit_br_down || hit_br_righ || hit_br_tr || hit_bl_br) {
-                br_obj.add_segment(seg, hit_br_righ);
+    return cost;
+}
+
+// distributes the objects among the four quadrants, returning false
+// and leaving children untouched when the cell should stay a leaf
+bool leave_node::split(const tree_config &config, arena &a, int depth, 
+    leave_node* children[4]) const {
+    if(depth >= config.max_depth || m_n_segments < config.min_segments) {
+        return false;
+    }
+    // nothing in here is a task scheduling point, so the buffers of
+    // the thread are not shared with another split
+    static thread_local leave_builder tr, tl, bl, br;
+    static thread_local node_object_builder tr_obj, tl_obj, bl_obj, br_obj;
+    R2 p0 = get_p0();
+    R2 p1 = get_p1();
+    R2 pc = get_pc();
+    tr.reset(pc, p1);
+    tl.reset(make_R2(p0[0],pc[1]), make_R2(pc[0],p1[1]));
+    bl.reset(p0, pc);
+    br.reset(make_R2(pc[0],p0[1]), make_R2(p1[0],pc[1]));
+    arena::mark start = a.get_mark();
+    for(auto &nobj : get_objects()) {
+        tr_obj.reset(nobj.m_ptr, nobj.m_w_increment);
+        tl_obj.reset(nobj.m_ptr, nobj.m_w_increment);
+        bl_obj.reset(nobj.m_ptr, nobj.m_w_increment);
+        br_obj.reset(nobj.m_ptr, nobj.m_w_increment);
+        for(auto ref : nobj.get_refs()) {
+            uint32_t index = segment_index(ref);
+            const path_segment* seg = nobj.get_segment(ref);
+            bool hit_tr_righ = hit_v_bound(p1[0], pc[1], p1[1], seg);
+            bool hit_br_righ = hit_v_bound(p1[0], p0[1], pc[1], seg);
+            bool hit_br_down = hit_h_bound(p0[1], pc[0], p1[0], seg);
+            bool hit_bl_down = hit_h_bound(p0[1], p0[0], pc[0], seg);
+            bool hit_bl_left = hit_v_bound(p0[0], p0[1], pc[1], seg);
+            bool hit_tl_left = hit_v_bound(p0[0], pc[1], p1[1], seg);
+            bool hit_tl_up   = hit_h_bound(p1[1], p0[0], pc[0], seg);
+            bool hit_tr_up   = hit_h_bound(p1[1], pc[0], p1[0], seg);
+            bool hit_tl_tr   = hit_v_bound(pc[0], pc[1], p1[1], seg);
+            bool hit_bl_tl   = hit_h_bound(pc[1], p0[0], pc[0], seg);
+            bool hit_bl_br   = hit_v_bound(pc[0], p0[1], pc[1], seg);
+            bool hit_br_tr   = hit_h_bound(pc[1], pc[0], p1[0], seg);
+            bool hit_c_inf   = seg->intersect(pc[0], pc[1]);
+            bool hit_cr_inf  = seg->intersect(p1[0], pc[1]);
+            bool hit_dc_inf  = seg->intersect(pc[0], p0[1]);
+            bool hit_br_inf  = seg->intersect(p1[0], p0[1]);
+            if(totally_inside(pc, p1, seg) || hit_tr_righ || hit_tr_up || hit_tl_tr || hit_br_tr) {
+                tr_obj.add_segment(index, hit_tr_righ);
+            }
+            if(totally_inside(make_R2(p0[0],pc[1]), make_R2(pc[0],p1[1]), seg) 
+                || hit_tl_left || hit_tl_tr || hit_tl_up || hit_bl_tl) {
+                tl_obj.add_segment(index, hit_tl_tr);
+            }
+            if(totally_inside(p0, pc, seg) || hit_bl_br || hit_bl_down || hit_bl_left || hit_bl_tl) {
+                bl_obj.add_segment(index, hit_bl_br);
+            }
+            if(totally_inside(make_R2(pc[0],p0[1]), make_R2(p1[0],pc[1]), seg) 
+                || hit_br_down || hit_br_righ || hit_br_tr || hit_bl_br) {
+                br_obj.add_segment(index, hit_br_righ);
             } 
             if(hit_c_inf) {
                 tl_obj.increment(seg->get_dir());
@@ -78,11 +132,15 @@ tree_node* leave_node::subdivide(int depth) {
                 br_obj.increment(seg->get_dir());
             }
         }
-        for(auto &shortcut : nobj.get_shortcuts()) {
-            bool hit_c_inf   = shortcut->intersect_shortcut(m_pc[0], m_pc[1]);
-            bool hit_cr_inf  = shortcut->intersect_shortcut(m_p1[0], m_pc[1]);
-            bool hit_dc_inf  = shortcut->intersect_shortcut(m_pc[0], m_p0[1]);
-            bool hit_br_inf  = shortcut->intersect_shortcut(m_p1[0], m_p0[1]);
+        for(auto ref : nobj.get_refs()) {
+            if(!is_shortcut(ref)) {
+                continue;
+            }
+            const path_segment* shortcut = nobj.get_segment(ref);
+            bool hit_c_inf   = shortcut->intersect_shortcut(pc[0], pc[1]);
+            bool hit_cr_inf  = shortcut->intersect_shortcut(p1[0], pc[1]);
+            bool hit_dc_inf  = shortcut->intersect_shortcut(pc[0], p0[1]);
+            bool hit_br_inf  = shortcut->intersect_shortcut(p1[0], p0[1]);
             if(hit_c_inf) {
                 tl_obj.increment(shortcut->get_sh_dir());
             }
@@ -97,47 +155,86 @@ tree_node* leave_node::subdivide(int depth) {
             }
         }
         if(tr_obj.get_size() || tr_obj.get_increment() != 0) {
-            tr->add_node_object(tr_obj);
+            tr.add_node_object(tr_obj, a);
         }
         if(tl_obj.get_size() || tl_obj.get_increment() != 0) {
-            tl->add_node_object(tl_obj);
+            tl.add_node_object(tl_obj, a);
         }
         if(bl_obj.get_size() || bl_obj.get_increment() != 0) {
-            bl->add_node_object(bl_obj);
+            bl.add_node_object(bl_obj, a);
         }
         if(br_obj.get_size() || br_obj.get_increment() != 0) {
-            br->add_node_object(br_obj);
+            br.add_node_object(br_obj, a);
         }
     }
-    depth++;
-    tree_node* ntr = nullptr; 
-    tree_node* ntl = nullptr;
-    tree_node* nbl = nullptr; 
-    tree_node* nbr = nullptr;
-    #pragma omp task shared(ntr)
-    {
-        ntr = tr->subdivide(depth);
-    }
-    #pragma omp task shared(ntl)
-    {
-        ntl = tl->subdivide(depth);
+    children[0] = tr.build(a);
+    children[1] = tl.build(a);
+    children[2] = bl.build(a);
+    children[3] = br.build(a);
+    if(config.split == e_split_mode::cost && get_area() > 0) {
+        // a sample pays the descent plus the cost of the child it lands in
+        constexpr double descent_cost = 1.0;
+        double area = get_area();
+        double split_cost = descent_cost;
+        for(int i = 0; i < 4; i++) {
+            split_cost += children[i]->sample_cost()*children[i]->get_area()/area;
+        }
+        if(split_cost >= sample_cost()) {
+            // the children were the last allocations of this thread
+            a.rewind(start);
+            return false;
+        }
     }
-    #pragma omp task shared(nbl)
-    {
-        nbl = bl->subdivide(depth);
+    return true;
+}
+
+tree_node* leave_node::subdivide(const tree_config &config, arena &a, int depth,
+    task_report *report) {
+    leave_node* children[4];
+    if(!split(config, a, depth, children)) {
+        return this;
     }
-    #pragma omp task shared(nbr)
-    {
-        nbr = br->subdivide(depth);
+    depth++;
+    // tr, tl, bl, br
+    tree_node* nodes[4] = { nullptr, nullptr, nullptr, nullptr };
+    for(int i = 0; i < 4; i++) {
+        // small subtrees cost less to build than to schedule, the
+        // current thread builds them while the tasks run elsewhere
+        if(depth <= config.task_depth && 
+            children[i]->m_n_segments >= config.task_segments) {
+            #pragma omp task shared(nodes, a)
+            {
+                if(report != nullptr) {
+                    report->add_task();
+                }
+                nodes[i] = children[i]->subdivide(config, a, depth, report);
+            }
+        } else {
+            if(report != nullptr) {
+                report->add_inline();
+            }
+            nodes[i] = children[i]->subdivide(config, a, depth, report);
+        }
     }
     #pragma omp taskwait 
     {
-        if(ntr != tr) delete tr;
-        if(ntl != tl) delete tl;
-        if(nbl != bl) delete bl;
-        if(nbr != br) delete br;
-        return new intern_node(m_p0, m_p1, ntr, ntl, nbl, nbr);
+        return a.make<intern_node>(get_p0(), get_p1(), nodes[0], nodes[1], 
+            nodes[2], nodes[3]);
     }
 }
 
-} // hadryan
\ No newline at end of file
+bool leave_builder::covers(const scene_object* ptr, int size, int increment) const {
+    if(size != 0 || !ptr->is_opaque() || !ptr->satisfy_wrule(increment)) {
+        return false;
+    }
+    // samples of pixels in the cell may reach one pixel outside it
+    bouding_box reach(m_p0-make_R2(1, 1), m_p1+make_R2(1, 1));
+    return ptr->get_bbox().contains(reach);
+}
+
+leave_node* leave_builder::build(arena &a) const {
+    return a.make<leave_node>(m_p0, m_p1, a.copy(m_objects.data(), m_objects.size()),
+        (int) m_objects.size(), m_n_segments, m_solid);
+}
+
+} // hadryan
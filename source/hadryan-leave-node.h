@@ -3,31 +3,103 @@
 
 #include "hadryan-node-object.h"
 #include "hadryan-tree-node.h"
+#include "hadryan-tree-config.h"
+#include "hadryan-range.h"
+#include "hadryan-arena.h"
+#include "hadryan-task-report.h"
 
 using namespace rvg;
 
 namespace hadryan {
 
 class leave_node : public tree_node {
-    std::vector<node_object> m_objects;
+    // in the arena of the tree
+    const node_object* m_objects;
+    int m_n_objects;
     int m_n_segments;
+    bool m_solid;
 public:
-    leave_node(const R2 &p0, const R2 &p1);
+    typedef range<const node_object> object_range;
+    leave_node(const R2 &p0, const R2 &p1, const node_object* objects,
+        int n_objects, int n_segments, bool solid);
     const leave_node* get_node_of(const double &x, const double &y) const;
+    void get_leaves(std::vector<const leave_node*> &leaves) const;
+    void flatten(flat_tree &tree, int index) const;
+    object_range get_objects() const;
+    bool is_solid() const;
+    bool hit_constant(const bouding_box &area) const;
+    double sample_cost() const;
+    bool split(const tree_config &config, arena &a, int depth, 
+        leave_node* children[4]) const;
+    tree_node* subdivide(const tree_config &config, arena &a, int depth = 0,
+        task_report *report = nullptr);
+};
+
+// Cell being filled with objects, front to back, in a buffer reused
+// from one cell to the next. build stores it in the arena.
+class leave_builder {
+    R2 m_p0;
+    R2 m_p1;
+    std::vector<node_object> m_objects;
+    int m_n_segments;
+    bool m_solid;
+    bool m_covered;
+    bool covers(const scene_object* ptr, int size, int increment) const;
+public:
+    void reset(const R2 &p0, const R2 &p1);
     void add_node_object(const node_object &node_obj);
-    const std::vector<node_object>& get_objects() const;
-    tree_node* subdivide(int depth = 0);
+    void add_node_object(const node_object_builder &node_obj, arena &a);
+    leave_node* build(arena &a) const;
 };
 
-inline void leave_node::add_node_object(const node_object &node_obj) {
+inline leave_node::object_range leave_node::get_objects() const {
+    return object_range(m_objects, m_objects+m_n_objects);
+}
+
+inline bool leave_node::is_solid() const {
+    return m_solid;
+}
+
+// true if every object covers all or none of area, which holds for
+// the whole cell when no segment falls inside it
+inline bool leave_node::hit_constant(const bouding_box &area) const {
+    for(auto &nobj : get_objects()) {
+        if(!nobj.hit_constant(area)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void leave_builder::reset(const R2 &p0, const R2 &p1) {
+    m_p0 = p0;
+    m_p1 = p1;
+    m_objects.clear();
+    m_n_segments = 0;
+    m_solid = true;
+    m_covered = false;
+}
+
+// objects arrive front to back, so everything after an opaque
+// object covering the whole cell is hidden and can be dropped
+inline void leave_builder::add_node_object(const node_object &node_obj) {
+    if(m_covered) {
+        return;
+    }
     m_objects.push_back(node_obj);
     m_n_segments += node_obj.get_size();
+    m_solid = m_solid && node_obj.m_ptr->is_solid();
+    m_covered = covers(node_obj.m_ptr, node_obj.get_size(), node_obj.get_increment());
 }
 
-inline const std::vector<node_object>& leave_node::get_objects() const {
-    return m_objects;
+// hidden objects are dropped before their segments reach the arena
+inline void leave_builder::add_node_object(const node_object_builder &node_obj, arena &a) {
+    if(m_covered) {
+        return;
+    }
+    add_node_object(node_obj.build(a));
 }
 
 } // hadryan
 
-#endif // HADRYAN_LEAVE_NODE_H
\ No newline at end of file
+#endif // HADRYAN_LEAVE_NODE_H
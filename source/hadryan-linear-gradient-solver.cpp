@@ -16,4 +16,8 @@ double linear_gradient_solver::convert(R2 p) const {
     return dot((p-m_p1), (m_p2_p1))/m_dot_p2_p1;
 }
 
+color_solver* linear_gradient_solver::clone() const {
+    return new linear_gradient_solver(*this);
+}
+
 } // hadryan
\ No newline at end of file
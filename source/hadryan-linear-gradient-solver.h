@@ -10,6 +10,7 @@ namespace hadryan {
 class linear_gradient_solver : public color_gradient_solver {
 public:
     linear_gradient_solver(const paint& pat);
+    color_solver* clone() const;
 
 private:
     const linear_gradient_data m_data;
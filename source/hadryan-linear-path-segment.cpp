@@ -1,5 +1,9 @@
 #include "hadryan-linear-path-segment.h"
 
+#include <algorithm>
+
+#include "hadryan-segment-row.h"
+
 using namespace rvg;
 
 namespace hadryan {
@@ -13,4 +17,52 @@ bool linear::implicit_hit(double x, double y) const {
     return (m_d[1]*((x - m_pi[0])*m_d[1] - (y - m_pi[1])*m_d[0]) <= 0);
 }
 
+path_segment* linear::clone() const {
+    return new linear(*this);
+}
+
+path_segment* linear::transformed(const xform &xf) const {
+    return new linear(off_grid(R2(xf.apply(m_pi))), off_grid(R2(xf.apply(m_pf))));
+}
+
+// integral over a height h of u clamped to [0, w], where u goes
+// linearly from u0 to u1. Between the points where u meets 0 and w
+// the clamp is linear, so each piece is a trapezoid.
+static double clamped_integral(double u0, double u1, double w, double h) {
+    double t[4] = { 0.0, 1.0, 0.0, 0.0 };
+    int n = 2;
+    if((u0 < 0) != (u1 < 0)) {
+        t[n++] = u0/(u0 - u1);
+    }
+    if((u0 < w) != (u1 < w)) {
+        t[n++] = (u0 - w)/(u0 - u1);
+    }
+    std::sort(t, t + n);
+    double sum = 0.0;
+    for(int i = 0; i+1 < n; i++) {
+        double a = std::min(std::max(u0 + (u1 - u0)*t[i], 0.0), w);
+        double b = std::min(std::max(u0 + (u1 - u0)*t[i+1], 0.0), w);
+        sum += (t[i+1] - t[i])*(a + b);
+    }
+    return 0.5*h*sum;
+}
+
+// the part of box on the left of the line, between y0 and y1
+bool linear::implicit_area(const bouding_box &box, double y0, double y1,
+    double &area) const {
+    double x0 = m_pi[0] + (y0 - m_pi[1])*m_d[0]/m_d[1];
+    double x1 = m_pi[0] + (y1 - m_pi[1])*m_d[0]/m_d[1];
+    const R2 &b0 = box.get_p0();
+    const R2 &b1 = box.get_p1();
+    area = clamped_integral(x0 - b0[0], x1 - b0[0], b1[0] - b0[0], y1 - y0);
+    return true;
+}
+
+int linear::get_row(double* row) const {
+    get_common_row(row);
+    row[segment_row::dx] = m_d[0];
+    row[segment_row::dy] = m_d[1];
+    return segment_row::linear_kind;
+}
+
 } // hadryan
\ No newline at end of file
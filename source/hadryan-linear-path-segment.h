@@ -11,6 +11,14 @@ class linear : public path_segment {
 public:
     linear(const R2 &p0, const R2 &p1);    
     bool implicit_hit(double x, double y) const;
+    double get_cost() const {return 1.0;}
+    path_segment* clone() const;
+    path_segment* transformed(const xform &xf) const;
+    int get_row(double* row) const;
+
+protected:
+    bool implicit_area(const bouding_box &box, double y0, double y1,
+        double &area) const;
     
 private:
     const R2 m_d;
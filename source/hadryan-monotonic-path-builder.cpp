@@ -1,5 +1,10 @@
 #include "hadryan-monotonic-path-builder.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "rvg-bezier.h"
+
 #include "hadryan-cubic-path-segment.h"
 #include "hadryan-quadratic-path-segment.h"
 
@@ -7,20 +12,82 @@ using namespace rvg;
 
 namespace hadryan {
 
+// halvings of a curve before its pieces become lines regardless of
+// the tolerance, at most 1024 lines per curve
+constexpr int max_flatten_depth = 10;
+
+static double chord_distance(const R2 &p0, const R2 &p1, const R2 &q) {
+    R2 d = p1-p0;
+    double l = len(d);
+    return l > 0 ? std::abs(cross(q-p0, d))/l : len(q-p0);
+}
+
+// the curve lies in the convex hull of its control points, so it is
+// within the distance of the inner ones from the chord
+template <typename BEZIER, size_t... Is>
+static double hull_distance(const BEZIER &B, const R2 &p0, const R2 &p1,
+    std::index_sequence<Is...>) {
+    double d[] = {chord_distance(p0, p1, project<R2>(std::get<Is+1>(B)))...};
+    return *std::max_element(std::begin(d), std::end(d));
+}
+
+// halves B until each piece is within m_tolerance of its chord. The
+// chords of a monotonic curve are monotonic in the same directions.
+// The split points are kept off the integer grid like the end points,
+// which off_grid leaves as they are.
+template <typename BEZIER>
+void monotonic_builder::flatten(const BEZIER &B, int depth) {
+    constexpr size_t degree = std::tuple_size<BEZIER>::value-1;
+    R2 p0 = project<R2>(std::get<0>(B));
+    R2 p1 = project<R2>(std::get<degree>(B));
+    if(depth >= max_flatten_depth || hull_distance(B, p0, p1,
+        std::make_index_sequence<degree-1>{}) <= m_tolerance) {
+        m_path.push_back(new linear(path_segment::off_grid(p0),
+            path_segment::off_grid(p1)));
+        m_lines++;
+        return;
+    }
+    // the inner points of both halves, sharing the middle one
+    auto s = bezier_split(B, rvgf(0.5));
+    flatten(std::tuple_cat(std::make_tuple(std::get<0>(B)),
+        tuple_drop<-static_cast<ptrdiff_t>(degree-1)>(s)), depth+1);
+    flatten(std::tuple_cat(tuple_drop<degree-1>(s),
+        std::make_tuple(std::get<degree>(B))), depth+1);
+}
+
 void monotonic_builder::do_linear_segment(rvgf x0, rvgf y0, rvgf x1, rvgf y1) {
     std::vector<R2> points{make_R2(x0, y0), make_R2(x1, y1)};
     m_path.push_back(new linear(points[0], points[1]));
 }
 
 void monotonic_builder::do_quadratic_segment(rvgf x0, rvgf y0, rvgf x1, rvgf y1,rvgf x2, rvgf y2) {
+    if(m_tolerance > 0) {
+        m_curves++;
+        flatten(std::make_tuple(make_R2(x0, y0), make_R2(x1, y1), make_R2(x2, y2)), 0);
+        return;
+    }
     m_path.push_back(new quadratic(make_R2(x0, y0), make_R2(x1, y1), make_R2(x2, y2)));
 }
 
+// the middle control point is homogeneous; only a positive weight
+// keeps the curve in the hull of the projected control points
 void monotonic_builder::do_rational_quadratic_segment(rvgf x0, rvgf y0, rvgf x1, rvgf y1, rvgf w1, rvgf x2, rvgf y2) {
-    m_path.push_back(new quadratic(make_R2(x0, y0), make_R2(x1, y1), make_R2(x2, y2), w1));    
+    if(m_tolerance > 0 && w1 > 0) {
+        m_curves++;
+        flatten(std::make_tuple(make_R3(x0, y0, 1), make_R3(x1, y1, w1),
+            make_R3(x2, y2, 1)), 0);
+        return;
+    }
+    m_path.push_back(new quadratic(make_R2(x0, y0), make_R2(x1, y1), make_R2(x2, y2), w1));
 }
 
 void monotonic_builder::do_cubic_segment(rvgf x0, rvgf y0, rvgf x1, rvgf y1, rvgf x2, rvgf y2, rvgf x3, rvgf y3) {
+    if(m_tolerance > 0) {
+        m_curves++;
+        flatten(std::make_tuple(make_R2(x0, y0), make_R2(x1, y1), make_R2(x2, y2),
+            make_R2(x3, y3)), 0);
+        return;
+    }
     m_path.push_back(new cubic(make_R2(x0, y0), make_R2(x1, y1), make_R2(x2, y2), make_R2(x3, y3)));
 }
 
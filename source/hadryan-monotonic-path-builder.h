@@ -17,9 +17,17 @@ friend i_input_path<monotonic_builder>;
 private:
     std::vector<path_segment*> m_path;
     R2 m_last_move;
+    // curves closer than m_tolerance pixels to their chords become
+    // linear segments, 0 keeps every curve
+    double m_tolerance;
+    int m_curves; // flattened so far
+    int m_lines;  // they were replaced by
+
+    template <typename BEZIER>
+    void flatten(const BEZIER &B, int depth);
 
 public:
-    monotonic_builder();
+    explicit monotonic_builder(double tolerance = 0.0);
     ~monotonic_builder() = default;
     
     void do_linear_segment(rvgf x0, rvgf y0, rvgf x1, rvgf y1);
@@ -31,10 +39,15 @@ public:
     void do_end_closed_contour(rvgf x0, rvgf y0);
 
     std::vector<path_segment*>& get();
+    int get_curves() const;
+    int get_lines() const;
 };
 
-inline monotonic_builder::monotonic_builder() 
+inline monotonic_builder::monotonic_builder(double tolerance) 
     : m_last_move(make_R2(0, 0))
+    , m_tolerance(tolerance)
+    , m_curves(0)
+    , m_lines(0)
 {}
 
 inline void monotonic_builder::do_begin_contour(rvgf x0, rvgf y0) {
@@ -54,6 +67,14 @@ inline std::vector<path_segment*>& monotonic_builder::get() {
     return m_path;
 }
 
+inline int monotonic_builder::get_curves() const {
+    return m_curves;
+}
+
+inline int monotonic_builder::get_lines() const {
+    return m_lines;
+}
+
 } // hadryan
 
 #endif // HADRYAN_MONOTONIC_PATH_BUILDER_H
\ No newline at end of file
@@ -1,33 +1,52 @@
 #include "hadryan-node-object.h"
 
+#include <algorithm>
+
+#include "hadryan-winding.h"
+
 using namespace rvg;
 
 namespace hadryan {
 
-node_object::node_object(const scene_object* ptr)
-    : m_ptr(ptr) {
+node_object::node_object()
+    : m_refs(nullptr)
+    , m_n_refs(0)
+    , m_ptr(nullptr) {
+}
+
+node_object::node_object(const scene_object* ptr, const segment_ref* refs, 
+    int n_refs, int w_increment)
+    : m_refs(refs)
+    , m_n_refs(n_refs)
+    , m_w_increment(w_increment)
+    , m_ptr(ptr) {
 }
 
 bool node_object::hit(const double x, const double y) const {
-    bool in_path = m_ptr->get_bbox().hit_inside(x, y);
-    if(in_path) { 
-        int sum = m_w_increment;
-        for(auto &seg : m_segments){
-            if(seg->intersect(x, y)) {
-                sum += seg->get_dir();
-            }
-        }
-        for(auto &sh : m_shortcuts){
-            if(sh->intersect(x, y)){
-                sum += sh->get_dir();
-            } 
-            if(sh->intersect_shortcut(x, y)) {
-                sum += sh->get_sh_dir();
-            }
-        }
-        return m_ptr->satisfy_wrule(sum);
-    }
-    return false;
+    return winding_hit(m_ptr, m_w_increment, m_refs, m_n_refs, x, y);
+}
+
+uint64_t node_object::hit_lanes(const sample_lanes &lanes, uint64_t open,
+    const lane_kernels &k) const {
+    return winding_lanes(m_ptr, m_w_increment, m_refs, m_n_refs, lanes, open, k);
+}
+
+bool node_object::hit_constant(const bouding_box &area) const {
+    return winding_constant(m_ptr, m_refs, m_n_refs, area);
+}
+
+bool node_object::cover(const bouding_box &area, double &fraction) const {
+    return winding_cover(m_ptr, m_w_increment, m_refs, m_n_refs, area, fraction);
+}
+
+node_object node_object_builder::build(arena &a) const {
+    int n_segments = m_segments.size();
+    int n_refs = n_segments + m_shortcuts.size();
+    auto refs = static_cast<segment_ref*>(a.allocate(n_refs*sizeof(segment_ref), 
+        alignof(segment_ref)));
+    std::copy(m_segments.begin(), m_segments.end(), refs);
+    std::copy(m_shortcuts.begin(), m_shortcuts.end(), refs+n_segments);
+    return node_object(m_ptr, refs, n_refs, m_w_increment);
 }
 
-} // hadryan
\ No newline at end of file
+} // hadryan
@@ -7,42 +7,58 @@
 
 #include "hadryan-path-segment.h"
 #include "hadryan-scene-object.h"
+#include "hadryan-range.h"
+#include "hadryan-arena.h"
+#include "hadryan-segment-ref.h"
+#include "hadryan-sample-lanes.h"
 
 using namespace rvg;
 
 namespace hadryan {
 
 class node_object {
-    // only points to segments inside scene_object
-    std::vector<const path_segment*> m_segments;
-    std::vector<const path_segment*> m_shortcuts;
+public:
+    typedef range<const segment_ref> ref_range;
+private:
+    // refers to segments inside scene_object, those crossing the cell
+    // followed by those whose shortcut crosses it, in the tree arena
+    const segment_ref* m_refs;
+    int m_n_refs;
 public:
     int m_w_increment = 0;
     const scene_object* m_ptr; 
 public:
-    node_object(const scene_object* ptr);
-    void add_segment(const path_segment* segment, bool shortcut = false);
+    node_object();
+    node_object(const scene_object* ptr, const segment_ref* refs, int n_refs,
+        int w_increment);
     bool hit(const double x, const double y) const;
-    const std::vector<const path_segment*> get_all_segments() const;
-    const std::vector<const path_segment*> get_shortcuts() const;
+    uint64_t hit_lanes(const sample_lanes &lanes, uint64_t open,
+        const lane_kernels &k) const;
+    bool hit_constant(const bouding_box &area) const;
+    bool cover(const bouding_box &area, double &fraction) const;
+    ref_range get_refs() const;
+    const path_segment* get_segment(segment_ref ref) const;
     RGBA8 get_color(const double x, const double y) const;
     int get_increment() const;
     int get_size() const;
-    void increment(int inc);    
 };
 
-
-inline void node_object::add_segment(const path_segment* segment, bool shortcut) {
-    if(shortcut) {
-        m_shortcuts.push_back(segment);
-    } else {
-        m_segments.push_back(segment);
-    }
-}
-
-inline void node_object::increment(int inc) {
-    m_w_increment += inc;
-}
+// node_object being clipped to a cell. The buffers are reused from
+// one object to the next, and build stores the result in the arena.
+class node_object_builder {
+    std::vector<segment_ref> m_segments;
+    std::vector<segment_ref> m_shortcuts;
+public:
+    int m_w_increment = 0;
+    const scene_object* m_ptr = nullptr;
+public:
+    void reset(const scene_object* ptr, int w_increment = 0);
+    void add_segment(uint32_t index, bool shortcut = false);
+    int get_increment() const;
+    int get_size() const;
+    void increment(int inc);
+    node_object build(arena &a) const;
+};
 
 inline RGBA8 node_object::get_color(const double x, const double y) const {
     return m_ptr->get_color(x, y);
@@ -53,20 +69,44 @@ inline int node_object::get_increment() const {
 }
 
 inline int node_object::get_size() const {
-    return m_segments.size() + m_shortcuts.size();
+    return m_n_refs;
 }
 
-inline const std::vector<const path_segment*> node_object::get_all_segments() const {
-    std::vector<const path_segment*> all_seg;
-    all_seg.insert(all_seg.end(), m_segments.begin(), m_segments.end());
-    all_seg.insert(all_seg.end(), m_shortcuts.begin(), m_shortcuts.end());
-    return all_seg;
+inline node_object::ref_range node_object::get_refs() const {
+    return ref_range(m_refs, m_refs+m_n_refs);
 }
 
-inline const std::vector<const path_segment*> node_object::get_shortcuts() const {
-    return m_shortcuts;
+inline const path_segment* node_object::get_segment(segment_ref ref) const {
+    return m_ptr->get_path()[segment_index(ref)];
+}
+
+inline void node_object_builder::reset(const scene_object* ptr, int w_increment) {
+    m_segments.clear();
+    m_shortcuts.clear();
+    m_w_increment = w_increment;
+    m_ptr = ptr;
+}
+
+inline void node_object_builder::add_segment(uint32_t index, bool shortcut) {
+    if(shortcut) {
+        m_shortcuts.push_back(make_segment_ref(index, true));
+    } else {
+        m_segments.push_back(make_segment_ref(index, false));
+    }
+}
+
+inline void node_object_builder::increment(int inc) {
+    m_w_increment += inc;
+}
+
+inline int node_object_builder::get_increment() const {
+    return m_w_increment;
+}
+
+inline int node_object_builder::get_size() const {
+    return m_segments.size() + m_shortcuts.size();
 }
 
 } // hadryan
 
-#endif // HADRYAN_NODE_OBJECT_H
\ No newline at end of file
+#endif // HADRYAN_NODE_OBJECT_H
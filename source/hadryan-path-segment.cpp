@@ -1,5 +1,9 @@
 #include "hadryan-path-segment.h"
 
+#include <algorithm>
+
+#include "hadryan-segment-row.h"
+
 using namespace rvg;
 
 namespace hadryan {
@@ -17,6 +21,15 @@ path_segment::path_segment(const R2 &p0, const R2 &p1)
     }
 } 
 
+// the implicit forms of every segment type are relative to m_pi, so
+// only the end points and the bounding box move
+void path_segment::translate(const R2 &d) {
+    m_pi = m_pi + d;
+    m_pf = m_pf + d;
+    m_right = (m_pf[0] > m_pi[0]) ? m_pf : m_pi;
+    m_bbox = bouding_box(m_pi, m_pf);
+}
+
 int path_segment::implicit_value(double x, double y) const {
     if(m_bbox.hit_inside(x, y)) {
         return implicit_hit(x, y) ? 1 : -1;
@@ -44,4 +57,61 @@ int path_segment::implicit_value(double x, double y) const {
     return 0;
 }
 
+bool path_segment::left_area(const bouding_box &box, double &area) const {
+    const R2 &b0 = box.get_p0();
+    const R2 &b1 = box.get_p1();
+    double y0 = std::max(b0[1], m_bbox.get_p0()[1]);
+    double y1 = std::min(b1[1], m_bbox.get_p1()[1]);
+    if(y0 >= y1 || b0[0] >= m_bbox.get_p1()[0]) {
+        area = 0.0;
+        return true;
+    }
+    if(b1[0] <= m_bbox.get_p0()[0]) {
+        area = (b1[0] - b0[0])*(y1 - y0);
+        return true;
+    }
+    return implicit_area(box, y0, y1, area);
+}
+
+// side of the curve of a point in the bounding box. The bottom and
+// top rows meet the curve only at an end point, where the implicit
+// test is not defined.
+bool path_segment::box_hit(double x, double y) const {
+    if(y == m_bbox.get_p0()[1]) {
+        return x < bot()[0];
+    }
+    if(y == m_bbox.get_p1()[1]) {
+        return x < top()[0];
+    }
+    return implicit_hit(x, y);
+}
+
+// A monotonic curve that crosses the part of box inside its bounding
+// box leaves corners of that part on both sides, so when all four
+// agree it is on one side, and the part of box on the left of the
+// bounding box is all that remains.
+bool path_segment::implicit_area(const bouding_box &box, double y0, double y1,
+    double &area) const {
+    const R2 &b0 = box.get_p0();
+    const R2 &b1 = box.get_p1();
+    double x0 = std::max(b0[0], m_bbox.get_p0()[0]);
+    double x1 = std::min(b1[0], m_bbox.get_p1()[0]);
+    bool hit = box_hit(x0, y0);
+    if(hit != box_hit(x1, y0) || hit != box_hit(x0, y1) || hit != box_hit(x1, y1)) {
+        return false;
+    }
+    area = ((hit ? x1 : x0) - b0[0])*(y1 - y0);
+    return true;
+}
+
+void path_segment::get_common_row(double* row) const {
+    row[segment_row::x0] = m_bbox.get_p0()[0];
+    row[segment_row::y0] = m_bbox.get_p0()[1];
+    row[segment_row::x1] = m_bbox.get_p1()[0];
+    row[segment_row::y1] = m_bbox.get_p1()[1];
+    row[segment_row::px] = m_pi[0];
+    row[segment_row::py] = m_pi[1];
+    row[segment_row::dir] = m_dir;
+}
+
 } // hadryan
\ No newline at end of file
@@ -1,7 +1,10 @@
 #ifndef HADRYAN_PATH_SEGMENT_H
 #define HADRYAN_PATH_SEGMENT_H
 
+#include <cmath>
+
 #include "rvg-point.h"
+#include "rvg-xform.h"
 
 #include "hadryan-bouding-box.h"
 
@@ -16,9 +19,15 @@ public:
     
     int implicit_value(double x, double y) const;
     virtual bool implicit_hit(double x, double y) const = 0;
+    // cost of implicit_hit relative to the linear one
+    virtual double get_cost() const = 0;
     
     bool intersect(const double x, const double y) const;
     bool intersect_shortcut(const double x, const double y) const;
+    // area of the part of box where intersect holds, false if the
+    // segment crosses box and its type has no exact area
+    bool left_area(const bouding_box &box, double &area) const;
+    double shortcut_area(const bouding_box &box) const;
     
     int get_dir() const;
     int get_sh_dir() const;
@@ -30,18 +39,42 @@ public:
     R2 top()   const;
     R2 bot()   const;
 
+    void translate(const R2 &d);
+    // a copy, for a scene_object moved while its original is kept
+    virtual path_segment* clone() const = 0;
+    // the same segment built from control points mapped by xf, which
+    // must keep it monotonic (an axis-aligned scale and translation)
+    virtual path_segment* transformed(const xform &xf) const = 0;
+    // writes the segment as a segment_row, returning its kind
+    virtual int get_row(double* row) const = 0;
+    static R2 off_grid(const R2 &p);
+
 protected:
-    const R2 m_pi;
-    const R2 m_pf;
-    const R2 m_right;
+    // left_area of a segment whose bounding box overlaps box, over
+    // the rows y0 to y1 of box the segment spans
+    virtual bool implicit_area(const bouding_box &box, double y0, double y1,
+        double &area) const;
+    bool box_hit(double x, double y) const;
+    void get_common_row(double* row) const;
+
+    R2 m_pi;
+    R2 m_pf;
+    R2 m_right;
 
     int m_dir;
     int m_sh_dir;
 
 public:
-    const bouding_box m_bbox;
+    bouding_box m_bbox;
 };
 
+// end and control points are kept off the integer grid of the cell
+// boundaries, as the input pipeline does
+inline R2 path_segment::off_grid(const R2 &p) {
+    return make_R2(p[0] == std::floor(p[0]) ? p[0]+0.001 : p[0], 
+        p[1] == std::floor(p[1]) ? p[1]+0.001 : p[1]);
+}
+
 inline bool path_segment::intersect(const double x, const double y) const {
     return !(m_bbox.hit_up(x,  y) || m_bbox.hit_right(x, y) || m_bbox.hit_down(x, y)) 
           &&(m_bbox.hit_left(x,y) || implicit_hit(x, y));
@@ -51,6 +84,16 @@ inline bool path_segment::intersect_shortcut(const double x, const double y) con
     return (x < m_right[0] && y >= m_right[1]);
 }
 
+// area of the part of box where intersect_shortcut holds
+inline double path_segment::shortcut_area(const bouding_box &box) const {
+    const R2 &b0 = box.get_p0();
+    const R2 &b1 = box.get_p1();
+    double w = std::min(std::max((double) (m_right[0] - b0[0]), 0.0),
+        (double) (b1[0] - b0[0]));
+    double h = std::max((double) (b1[1] - std::max(m_right[1], b0[1])), 0.0);
+    return w*h;
+}
+
 inline int path_segment::get_dir() const {
     return m_dir;
 }
@@ -1,5 +1,7 @@
 #include "hadryan-quadratic-path-segment.h"
 
+#include "hadryan-segment-row.h"
+
 using namespace rvg;
 
 namespace hadryan {
@@ -16,6 +18,7 @@ quadratic::quadratic(const R2 &p0, const R2 &p1, const R2& p2, double w)
     , m_D(-8.0*m_p1[0]*m_p1[1]+4.0*w*m_p2[0]*m_p1[1]+4.0*w*m_p1[0]*m_p2[1]-2.0*m_p2[0]*m_p2[1])
     , m_E(4.0*m_p1[1]*m_p1[1]-4.0*w*m_p1[1]*m_p2[1]+m_p2[1]*m_p2[1]) 
     , m_der((2*m_p2[1]*(-m_p2[0]*m_p1[1]+m_p1[0]*m_p2[1]))) 
+    , m_w(w)
 {}
 
 bool quadratic::implicit_hit(double x, double y) const {
@@ -26,4 +29,32 @@ bool quadratic::implicit_hit(double x, double y) const {
        ||(!m_cvx && (diag_hit || hit_me(x, y)));
 }
 
+path_segment* quadratic::clone() const {
+    return new quadratic(*this);
+}
+
+// the middle control point is homogeneous, so it takes the
+// translation in proportion to its weight
+path_segment* quadratic::transformed(const xform &xf) const {
+    R2 p1 = m_p1 + m_pi*m_w;
+    R2 q1 = make_R2(xf[0][0]*p1[0] + xf[0][1]*p1[1] + xf[0][2]*m_w,
+        xf[1][0]*p1[0] + xf[1][1]*p1[1] + xf[1][2]*m_w);
+    return new quadratic(off_grid(R2(xf.apply(m_pi))), off_grid(q1), 
+        off_grid(R2(xf.apply(m_pf))), m_w);
+}
+
+int quadratic::get_row(double* row) const {
+    get_common_row(row);
+    row[segment_row::qx] = m_p2[0];
+    row[segment_row::qy] = m_p2[1];
+    row[segment_row::qa] = m_A;
+    row[segment_row::qb] = m_B;
+    row[segment_row::qc] = m_C;
+    row[segment_row::qd] = m_D;
+    row[segment_row::qe] = m_E;
+    row[segment_row::qder] = m_der;
+    row[segment_row::qcvx] = m_cvx;
+    return segment_row::quadratic_kind;
+}
+
 } // hadryan
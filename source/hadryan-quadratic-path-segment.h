@@ -19,9 +19,14 @@ protected:
     const double m_D;
     const double m_E;
     const double m_der;
+    const double m_w;
 public:
     quadratic(const R2 &p0, const R2 &p1, const R2& p2, double w = 1.0);
     bool implicit_hit(double x, double y) const;
+    double get_cost() const {return 3.0;}
+    path_segment* clone() const;
+    path_segment* transformed(const xform &xf) const;
+    int get_row(double* row) const;
     bool hit_me(double x, double y) const;
 };
 
@@ -31,4 +31,8 @@ double radial_gradient_solver::convert(R2 p_in) const {
     return A/(-B + det);
 }
     
+color_solver* radial_gradient_solver::clone() const {
+    return new radial_gradient_solver(*this);
+}
+
 } // hadryan
\ No newline at end of file
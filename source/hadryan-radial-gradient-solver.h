@@ -10,6 +10,7 @@ namespace hadryan {
 class radial_gradient_solver : public color_gradient_solver {
 public:
     radial_gradient_solver(const paint& pat);
+    color_solver* clone() const;
 
 private:
     const radial_gradient_data m_data;
@@ -0,0 +1,22 @@
+#ifndef HADRYAN_RANGE_H
+#define HADRYAN_RANGE_H
+
+#include <cstddef>
+
+namespace hadryan {
+
+// contiguous run of elements stored elsewhere, for range based loops
+template <typename T>
+class range {
+    T* m_begin;
+    T* m_end;
+public:
+    range(T* b, T* e): m_begin(b), m_end(e) {}
+    T* begin() const {return m_begin;}
+    T* end() const {return m_end;}
+    size_t size() const {return m_end-m_begin;}
+};
+
+} // hadryan
+
+#endif // HADRYAN_RANGE_H
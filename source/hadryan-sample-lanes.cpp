@@ -0,0 +1,329 @@
+#include "hadryan-sample-lanes.h"
+
+#include <cfloat>
+#include <cmath>
+#include <type_traits>
+
+#include "hadryan-segment-store.h"
+#include "hadryan-simd-target.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+// Contracting into fused multiply adds, which the wider instruction
+// sets allow, would round differently from the scalar tests.
+#pragma GCC optimize ("fp-contract=off")
+
+// The kernels make the tests of the segment_store kernels for every
+// lane, without branches, so the loops map onto vector instructions.
+// They are inlined into a copy per instruction set and precision below.
+
+#define HADRYAN_LANES_INLINE inline __attribute__((always_inline))
+
+// Lanes of precision T and the origin positions are moved to. Double
+// lanes are the sample positions themselves, so the tests round as the
+// scalar ones do. Float lanes are offsets from the pixel center, and
+// float rows are moved next to it before the tests.
+template <typename T>
+struct lane_frame;
+
+template <>
+struct lane_frame<double> {
+    const double* x;
+    const double* y;
+    double cx = 0.0;
+    double cy = 0.0;
+    explicit lane_frame(const sample_lanes &lanes)
+        : x(lanes.x)
+        , y(lanes.y)
+    {}
+};
+
+template <>
+struct lane_frame<float> {
+    const float* x;
+    const float* y;
+    float cx;
+    float cy;
+    explicit lane_frame(const sample_lanes &lanes)
+        : x(lanes.ox)
+        , y(lanes.oy)
+        , cx((float) lanes.cx)
+        , cy((float) lanes.cy)
+    {}
+};
+
+template <typename T>
+HADRYAN_LANES_INLINE void linear_lanes(const T* row, size_t stride,
+    const sample_lanes &lanes, int32_t* sum) {
+    const lane_frame<T> f(lanes);
+    const T x0 = row[segment_row::x0*stride] - f.cx;
+    const T y0 = row[segment_row::y0*stride] - f.cy;
+    const T x1 = row[segment_row::x1*stride] - f.cx;
+    const T y1 = row[segment_row::y1*stride] - f.cy;
+    const T px = row[segment_row::px*stride] - f.cx;
+    const T py = row[segment_row::py*stride] - f.cy;
+    const int32_t dir = (int32_t) row[segment_row::dir*stride];
+    const T dx = row[segment_row::dx*stride];
+    const T dy = row[segment_row::dy*stride];
+    #pragma omp simd
+    for(int i = 0; i < lanes.n; i++) {
+        T x = f.x[i];
+        T y = f.y[i];
+        bool inside = (y < y1) & (x <= x1) & (y >= y0);
+        bool left = (x <= x0) | (dy*((x - px)*dy - (y - py)*dx) <= 0);
+        sum[i] += (inside & left) ? dir : 0;
+    }
+}
+
+template <typename T>
+HADRYAN_LANES_INLINE void quadratic_lanes(const T* row, size_t stride,
+    const sample_lanes &lanes, int32_t* sum) {
+    const lane_frame<T> f(lanes);
+    const T x0 = row[segment_row::x0*stride] - f.cx;
+    const T y0 = row[segment_row::y0*stride] - f.cy;
+    const T x1 = row[segment_row::x1*stride] - f.cx;
+    const T y1 = row[segment_row::y1*stride] - f.cy;
+    const T px = row[segment_row::px*stride] - f.cx;
+    const T py = row[segment_row::py*stride] - f.cy;
+    const int32_t dir = (int32_t) row[segment_row::dir*stride];
+    const T qx = row[segment_row::qx*stride];
+    const T qy = row[segment_row::qy*stride];
+    const T qa = row[segment_row::qa*stride];
+    const T qb = row[segment_row::qb*stride];
+    const T qc = row[segment_row::qc*stride];
+    const T qd = row[segment_row::qd*stride];
+    const T qe = row[segment_row::qe*stride];
+    const T qder = row[segment_row::qder*stride];
+    // a convex curve needs both sides, a concave one either
+    const bool concave = row[segment_row::qcvx*stride] == 0;
+    #pragma omp simd
+    for(int i = 0; i < lanes.n; i++) {
+        T x = f.x[i];
+        T y = f.y[i];
+        T lx = x - px;
+        T ly = y - py;
+        bool inside = (y < y1) & (x <= x1) & (y >= y0);
+        bool diag = qy*(lx*qy - ly*qx) <= 0;
+        bool me = qder*((ly*(ly*qa + qb) + lx*(qc + ly*qd + lx*qe))) <= 0;
+        bool side = (diag & me) | ((diag | me) & concave);
+        sum[i] += (inside & ((x <= x0) | side)) ? dir : 0;
+    }
+}
+
+template <typename T>
+HADRYAN_LANES_INLINE void cubic_lanes(const T* row, size_t stride,
+    const sample_lanes &lanes, int32_t* sum) {
+    const lane_frame<T> f(lanes);
+    const T x0 = row[segment_row::x0*stride] - f.cx;
+    const T y0 = row[segment_row::y0*stride] - f.cy;
+    const T x1 = row[segment_row::x1*stride] - f.cx;
+    const T y1 = row[segment_row::y1*stride] - f.cy;
+    const T px = row[segment_row::px*stride] - f.cx;
+    const T py = row[segment_row::py*stride] - f.cy;
+    const int32_t dir = (int32_t) row[segment_row::dir*stride];
+    const T vx = row[segment_row::vx*stride];
+    const T vy = row[segment_row::vy*stride];
+    const T wx = row[segment_row::wx*stride];
+    const T wy = row[segment_row::wy*stride];
+    const T ca = row[segment_row::ca*stride];
+    const T cb = row[segment_row::cb*stride];
+    const T cc = row[segment_row::cc*stride];
+    const T cd = row[segment_row::cd*stride];
+    const T ce = row[segment_row::ce*stride];
+    const T cf = row[segment_row::cf*stride];
+    const T cg = row[segment_row::cg*stride];
+    const T ch = row[segment_row::ch*stride];
+    const T ci = row[segment_row::ci*stride];
+    const T cder = row[segment_row::cder*stride];
+    const T zero = 0;
+    #pragma omp simd
+    for(int i = 0; i < lanes.n; i++) {
+        T x = f.x[i];
+        T y = f.y[i];
+        T lx = x - px;
+        T ly = y - py;
+        bool inside = (y < y1) & (x <= x1) & (y >= y0);
+        bool h0 = linear_intersect(zero, zero, vx, vy, lx, ly);
+        bool h1 = linear_intersect(vx, vy, wx, wy, lx, ly);
+        bool h2 = linear_intersect(wx, wy, zero, zero, lx, ly);
+        bool me = cder*(ly*(ca + ly*(ly*cb + cc)) + lx*(cd + ly*(ce + ly*cf)
+            + lx*(cg + ly*ch + lx*ci))) <= 0;
+        // two of the triangle sides, or one and the curve
+        bool odd = h0 ^ h1 ^ h2;
+        bool two = (h0 | h1 | h2) & !odd;
+        bool one = odd & !(h0 & h1 & h2);
+        sum[i] += (inside & ((x <= x0) | two | (one & me))) ? dir : 0;
+    }
+}
+
+template <typename T>
+HADRYAN_LANES_INLINE void shortcut_lanes(const T* row, size_t stride,
+    const sample_lanes &lanes, int32_t* sum) {
+    const lane_frame<T> f(lanes);
+    const T rx = row[segment_row::rx*stride] - f.cx;
+    const T ry = row[segment_row::ry*stride] - f.cy;
+    const int32_t sh_dir = (int32_t) row[segment_row::sh_dir*stride];
+    #pragma omp simd
+    for(int i = 0; i < lanes.n; i++) {
+        sum[i] += ((f.x[i] < rx) & (f.y[i] >= ry)) ? sh_dir : 0;
+    }
+}
+
+// Rounding a position to float moves it by FLT_EPSILON/2 times its
+// size, and rounds an implicit value by about FLT_EPSILON times the
+// size m of its terms over the bounding box. Over the gradient at the
+// first end point, that is how far from the curve the sign can come
+// out wrong. Positions far from the origin, almost straight curves
+// and cusps at an end point have tiny gradients next to their
+// coefficients, and values beyond the float range overflow, so those
+// rows are tested in double.
+constexpr double max_single_error = 1.0/128.0; // pixels
+
+HADRYAN_LANES_INLINE bool single_safe(double m, double gx, double gy) {
+    return m < 1e30 && FLT_EPSILON*m <= max_single_error*std::sqrt(gx*gx + gy*gy);
+}
+
+HADRYAN_LANES_INLINE bool position_single_safe(const double* row, size_t stride,
+    int x, int y) {
+    return FLT_EPSILON*std::max(std::abs(row[x*stride]), std::abs(row[y*stride]))
+        <= 0.25*max_single_error;
+}
+
+HADRYAN_LANES_INLINE bool box_single_safe(const double* row, size_t stride) {
+    return position_single_safe(row, stride, segment_row::x0, segment_row::y0)
+        && position_single_safe(row, stride, segment_row::x1, segment_row::y1);
+}
+
+HADRYAN_LANES_INLINE double row_side(const double* row, size_t stride) {
+    return std::max(row[segment_row::x1*stride] - row[segment_row::x0*stride],
+        row[segment_row::y1*stride] - row[segment_row::y0*stride]);
+}
+
+HADRYAN_LANES_INLINE bool quadratic_single_safe(const double* row, size_t stride) {
+    const double s = row_side(row, stride);
+    const double m = s*(std::abs(row[segment_row::qb*stride])
+        + std::abs(row[segment_row::qc*stride]))
+        + s*s*(std::abs(row[segment_row::qa*stride])
+        + std::abs(row[segment_row::qd*stride])
+        + std::abs(row[segment_row::qe*stride]));
+    return box_single_safe(row, stride) && single_safe(m,
+        row[segment_row::qc*stride], row[segment_row::qb*stride]);
+}
+
+HADRYAN_LANES_INLINE bool cubic_single_safe(const double* row, size_t stride) {
+    const double s = row_side(row, stride);
+    const double m = s*(std::abs(row[segment_row::ca*stride])
+        + std::abs(row[segment_row::cd*stride]))
+        + s*s*(std::abs(row[segment_row::cc*stride])
+        + std::abs(row[segment_row::ce*stride])
+        + std::abs(row[segment_row::cg*stride]))
+        + s*s*s*(std::abs(row[segment_row::cb*stride])
+        + std::abs(row[segment_row::cf*stride])
+        + std::abs(row[segment_row::ch*stride])
+        + std::abs(row[segment_row::ci*stride]));
+    return box_single_safe(row, stride) && single_safe(m,
+        row[segment_row::cd*stride], row[segment_row::ca*stride]);
+}
+
+HADRYAN_LANES_INLINE bool kind_single_safe(int kind, const double* row, size_t stride) {
+    switch(kind) {
+        case segment_row::linear_kind:
+            return box_single_safe(row, stride);
+        case segment_row::quadratic_kind:
+            return quadratic_single_safe(row, stride);
+        case segment_row::cubic_kind:
+            return cubic_single_safe(row, stride);
+        default:
+            return position_single_safe(row, stride, segment_row::rx, segment_row::ry);
+    }
+}
+
+bool lane_kernels::single_safe(int kind, const double* row, size_t stride) {
+    return kind_single_safe(kind, row, stride);
+}
+
+// the row of kind rounded to float, for the single precision kernels
+HADRYAN_LANES_INLINE void single_row(int kind, const double* row, size_t stride,
+    float* single) {
+    for(int c = 0; c < segment_row::width(kind); c++) {
+        single[c] = (float) row[c*stride];
+    }
+}
+
+// defines the kernels of one instruction set and precision, named
+// after them, reading rows of T
+#define HADRYAN_LANE_KERNELS(NAME, T, TARGET) \
+    TARGET static void NAME##_linear(const T* row, size_t stride, \
+        const sample_lanes &lanes, int32_t* sum) { \
+        linear_lanes<T>(row, stride, lanes, sum); \
+    } \
+    TARGET static void NAME##_quadratic(const T* row, size_t stride, \
+        const sample_lanes &lanes, int32_t* sum) { \
+        quadratic_lanes<T>(row, stride, lanes, sum); \
+    } \
+    TARGET static void NAME##_cubic(const T* row, size_t stride, \
+        const sample_lanes &lanes, int32_t* sum) { \
+        cubic_lanes<T>(row, stride, lanes, sum); \
+    } \
+    TARGET static void NAME##_shortcut(const T* row, size_t stride, \
+        const sample_lanes &lanes, int32_t* sum) { \
+        shortcut_lanes<T>(row, stride, lanes, sum); \
+    }
+
+// kernels of a single precision set taking double rows: rows float
+// can test are rounded once and tested in float, the others in double
+#define HADRYAN_CHECKED_KERNEL(NAME, KIND, TARGET) \
+    TARGET static void NAME##_checked_##KIND(const double* row, size_t stride, \
+        const sample_lanes &lanes, int32_t* sum) { \
+        if(kind_single_safe(segment_row::KIND##_kind, row, stride)) { \
+            float single[segment_row::max_width]; \
+            single_row(segment_row::KIND##_kind, row, stride, single); \
+            KIND##_lanes<float>(single, 1, lanes, sum); \
+        } else { \
+            KIND##_lanes<double>(row, stride, lanes, sum); \
+        } \
+    }
+
+// the double and single precision sets of one instruction set
+#define HADRYAN_LANE_SETS(NAME, TARGET) \
+    HADRYAN_LANE_KERNELS(NAME, double, TARGET) \
+    HADRYAN_LANE_KERNELS(NAME##_float, float, TARGET) \
+    HADRYAN_CHECKED_KERNEL(NAME, linear, TARGET) \
+    HADRYAN_CHECKED_KERNEL(NAME, quadratic, TARGET) \
+    HADRYAN_CHECKED_KERNEL(NAME, cubic, TARGET) \
+    HADRYAN_CHECKED_KERNEL(NAME, shortcut, TARGET) \
+    static const lane_kernels NAME##_kernels = { #NAME, \
+        { NAME##_linear, NAME##_quadratic, NAME##_cubic, NAME##_shortcut }, \
+        { nullptr, nullptr, nullptr, nullptr } }; \
+    static const lane_kernels NAME##_float_kernels = { #NAME "_float", \
+        { NAME##_checked_linear, NAME##_checked_quadratic, \
+            NAME##_checked_cubic, NAME##_checked_shortcut }, \
+        { NAME##_float_linear, NAME##_float_quadratic, NAME##_float_cubic, \
+            NAME##_float_shortcut } };
+
+HADRYAN_LANE_SETS(scalar, )
+
+#ifdef HADRYAN_X86
+HADRYAN_LANE_SETS(avx2, HADRYAN_AVX2)
+HADRYAN_LANE_SETS(avx512, HADRYAN_AVX512)
+#endif
+
+const lane_kernels* lane_kernels::get(e_simd_mode mode, e_precision_mode precision) {
+    if(mode == e_simd_mode::off) {
+        return nullptr;
+    }
+    const bool single = precision == e_precision_mode::single;
+#ifdef HADRYAN_X86
+    if(cpu_has_avx512() && (mode == e_simd_mode::avx512 || mode == e_simd_mode::automatic)) {
+        return single ? &avx512_float_kernels : &avx512_kernels;
+    }
+    if(cpu_has_avx2() && mode != e_simd_mode::scalar) {
+        return single ? &avx2_float_kernels : &avx2_kernels;
+    }
+#endif
+    return single ? &scalar_float_kernels : &scalar_kernels;
+}
+
+} // hadryan
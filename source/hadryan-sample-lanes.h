@@ -0,0 +1,128 @@
+#ifndef HADRYAN_SAMPLE_LANES_H
+#define HADRYAN_SAMPLE_LANES_H
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "rvg-point.h"
+
+#include "hadryan-bouding-box.h"
+#include "hadryan-segment-row.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+enum class e_simd_mode {
+    off,       // each sample walks the segments on its own
+    scalar,    // samples of a pixel tested together, without vector units
+    avx2,      // 4 samples per instruction
+    avx512,    // 8 samples per instruction
+    automatic  // the widest of the above the processor supports
+};
+
+enum class e_precision_mode {
+    full,   // segment tests in double precision
+    single  // segment tests in float, relative to the pixel center
+};
+
+// The samples of one pixel, each a lane of the winding kernels, which
+// test one segment against all of them before moving to the next.
+struct sample_lanes {
+    static constexpr int max_lanes = 64;
+    double x[max_lanes];
+    double y[max_lanes];
+    // offsets from the center the lanes were set around, for the
+    // single precision kernels, which move each segment next to it
+    float ox[max_lanes];
+    float oy[max_lanes];
+    double cx;
+    double cy;
+    int n;
+    // bounds of the lanes, to skip segments none of them can cross
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+
+    void set(const R2* offsets, int n_offsets, float px, float py);
+    uint64_t all() const;
+    uint64_t inside(const bouding_box &bbox, uint64_t open) const;
+    bool miss_segment(const double* row, size_t stride) const;
+    bool miss_shortcut(const double* row, size_t stride) const;
+};
+
+// Adds to sum the winding each lane gets from one segment_row, whose
+// columns are stride elements apart. Double kernels test the lanes at
+// their positions, single ones take the row in float and test the
+// lanes as offsets from their center.
+typedef void (*lane_kernel)(const double* row, size_t stride,
+    const sample_lanes &lanes, int32_t* sum);
+typedef void (*single_lane_kernel)(const float* row, size_t stride,
+    const sample_lanes &lanes, int32_t* sum);
+
+// Kernels of each segment kind compiled for one instruction set and
+// precision. get picks them at run time, falling back to narrower sets
+// the processor supports, and gives nullptr when mode is off. In a
+// single precision set, kernel rounds each row single_safe accepts to
+// float and tests the others in double, and single takes rows already
+// rounded, which single_safe must have accepted; double sets have no
+// single kernels.
+struct lane_kernels {
+    const char* name;
+    lane_kernel kernel[segment_row::n_kinds];
+    single_lane_kernel single[segment_row::n_kinds];
+
+    static const lane_kernels* get(e_simd_mode mode,
+        e_precision_mode precision = e_precision_mode::full);
+    // whether float tests the row of kind to 1/128 pixel
+    static bool single_safe(int kind, const double* row, size_t stride);
+};
+
+inline void sample_lanes::set(const R2* offsets, int n_offsets, float px, float py) {
+    n = n_offsets;
+    cx = px;
+    cy = py;
+    for(int i = 0; i < n; i++) {
+        x[i] = px + offsets[i][0];
+        y[i] = py + offsets[i][1];
+        ox[i] = (float) offsets[i][0];
+        oy[i] = (float) offsets[i][1];
+    }
+    x0 = x1 = x[0];
+    y0 = y1 = y[0];
+    for(int i = 1; i < n; i++) {
+        x0 = std::min(x0, x[i]);
+        x1 = std::max(x1, x[i]);
+        y0 = std::min(y0, y[i]);
+        y1 = std::max(y1, y[i]);
+    }
+}
+
+inline uint64_t sample_lanes::all() const {
+    return n == max_lanes ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1;
+}
+
+// the lanes of open that bbox.hit_inside accepts
+inline uint64_t sample_lanes::inside(const bouding_box &bbox, uint64_t open) const {
+    uint64_t mask = 0;
+    for(int i = 0; i < n; i++) {
+        mask |= (uint64_t) bbox.hit_inside(x[i], y[i]) << i;
+    }
+    return mask & open;
+}
+
+// every lane fails the bounding box test path_segment::intersect starts with
+inline bool sample_lanes::miss_segment(const double* row, size_t stride) const {
+    return y0 >= row[segment_row::y1*stride] || x0 > row[segment_row::x1*stride]
+        || y1 < row[segment_row::y0*stride];
+}
+
+inline bool sample_lanes::miss_shortcut(const double* row, size_t stride) const {
+    return x0 >= row[segment_row::rx*stride] || y1 < row[segment_row::ry*stride];
+}
+
+} // hadryan
+
+#endif // HADRYAN_SAMPLE_LANES_H
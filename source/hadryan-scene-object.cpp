@@ -9,19 +9,13 @@ using namespace rvg;
 namespace hadryan {
 
 scene_object::scene_object(std::vector<path_segment*> &path, const e_winding_rule &wrule, const paint &paint_in) 
-    : m_wrule(wrule) {
+    : m_wrule(wrule)
+    , m_solid(!paint_in.is_linear_gradient() && !paint_in.is_radial_gradient() 
+        && !paint_in.is_texture())
+    , m_opaque(paint_in.is_solid_color() && (int) paint_in.get_solid_color()[3] == 255
+        && (int) paint_in.get_opacity() == 255) {
     m_path = path;
-    R2 bb0 = path[0]->first();
-    R2 bb1 = path[0]->last();
-    for(auto &seg : path){
-        R2 f = seg->first();
-        R2 l = seg->last();
-        bb0 = make_R2(std::min(bb0[0], f[0]), std::min(bb0[1], f[1]));
-        bb0 = make_R2(std::min(bb0[0], l[0]), std::min(bb0[1], l[1]));
-        bb1 = make_R2(std::max(bb1[0], f[0]), std::max(bb1[1], f[1]));
-        bb1 = make_R2(std::max(bb1[0], l[0]), std::max(bb1[1], l[1]));
-    }
-    m_bbox = bouding_box(bb0, bb1);
+    update_bbox();
     if(paint_in.is_solid_color()) {
         m_color = std::make_unique<color_solver>(paint_in);
     } else if(paint_in.is_linear_gradient()) {
@@ -38,6 +32,75 @@ scene_object::scene_object(std::vector<path_segment*> &path, const e_winding_rul
     }
 }
 
+// rhs with another path and a copy of its color solver
+scene_object::scene_object(const scene_object &rhs, std::vector<path_segment*> &&path)
+    : m_wrule(rhs.m_wrule)
+    , m_solid(rhs.m_solid)
+    , m_opaque(rhs.m_opaque)
+    , m_color(rhs.m_color->clone())
+    , m_path(std::move(path))
+    , m_bbox(rhs.m_bbox)
+{}
+
+void scene_object::update_bbox() {
+    R2 bb0 = m_path[0]->first();
+    R2 bb1 = m_path[0]->last();
+    for(auto &seg : m_path){
+        R2 f = seg->first();
+        R2 l = seg->last();
+        bb0 = make_R2(std::min(bb0[0], f[0]), std::min(bb0[1], f[1]));
+        bb0 = make_R2(std::min(bb0[0], l[0]), std::min(bb0[1], l[1]));
+        bb1 = make_R2(std::max(bb1[0], f[0]), std::max(bb1[1], f[1]));
+        bb1 = make_R2(std::max(bb1[0], l[0]), std::max(bb1[1], l[1]));
+    }
+    m_bbox = bouding_box(bb0, bb1);
+}
+
+void scene_object::translate(const R2 &d) {
+    for(auto &seg : m_path) {
+        seg->translate(d);
+    }
+    m_bbox = bouding_box(m_bbox.get_p0() + d, m_bbox.get_p1() + d);
+    m_color->translate(d);
+}
+
+// rebuilds the segments from their mapped control points, skipping
+// the input pipeline and the monotonization
+void scene_object::transform(const xform &xf) {
+    for(auto &seg : m_path) {
+        path_segment* moved = seg->transformed(xf);
+        delete seg;
+        seg = moved;
+    }
+    update_bbox();
+    m_color->transform(xf);
+}
+
+// translate and transform on a copy, for objects that the trees of
+// another accelerated still refer to
+scene_object* scene_object::translated(const R2 &d) const {
+    std::vector<path_segment*> path;
+    path.reserve(m_path.size());
+    for(auto seg : m_path) {
+        path.push_back(seg->clone());
+    }
+    scene_object* obj = new scene_object(*this, std::move(path));
+    obj->translate(d);
+    return obj;
+}
+
+scene_object* scene_object::transformed(const xform &xf) const {
+    std::vector<path_segment*> path;
+    path.reserve(m_path.size());
+    for(auto seg : m_path) {
+        path.push_back(seg->transformed(xf));
+    }
+    scene_object* obj = new scene_object(*this, std::move(path));
+    obj->update_bbox();
+    obj->m_color->transform(xf);
+    return obj;
+}
+
 scene_object::~scene_object() {
     for(auto &seg : m_path) {
         delete seg;
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <memory>
+#include <cmath>
+#include <algorithm>
 
 #include "rvg-paint.h"
 
@@ -17,12 +19,16 @@ namespace hadryan {
 class scene_object {
 private:
     e_winding_rule m_wrule;
+    bool m_solid;
+    bool m_opaque;
     std::unique_ptr<color_solver> m_color;
     std::vector<path_segment*> m_path;
     bouding_box m_bbox;
 
     scene_object(const scene_object &rhs) = delete;
     scene_object& operator=(const scene_object &rhs) = delete;
+    scene_object(const scene_object &rhs, std::vector<path_segment*> &&path);
+    void update_bbox();
 public:
 
 public:
@@ -30,9 +36,16 @@ public:
     ~scene_object();
     RGBA8 get_color(const double x, const double y) const;
     bool satisfy_wrule(int winding) const;
+    double cover_wrule(double winding) const;
+    bool is_solid() const {return m_solid;}
+    bool is_opaque() const {return m_opaque;}
 
     const auto& get_path() const {return m_path;}
     const bouding_box& get_bbox() const {return m_bbox;}
+    void translate(const R2 &d);
+    void transform(const xform &xf);
+    scene_object* translated(const R2 &d) const;
+    scene_object* transformed(const xform &xf) const;
 };
 
 inline bool scene_object::satisfy_wrule(int winding) const {
@@ -45,6 +58,22 @@ inline bool scene_object::satisfy_wrule(int winding) const {
     return false;
 }
 
+// fraction of a region with mean winding number winding the rule
+// accepts, when the winding takes at most two consecutive values
+// there: the magnitude clamped to 1 for non-zero, folded into [0, 1]
+// for odd
+inline double scene_object::cover_wrule(double winding) const {
+    double w = std::abs(winding);
+    if(m_wrule == e_winding_rule::non_zero) {
+        return std::min(w, 1.0);
+    }
+    else if(m_wrule == e_winding_rule::odd) {
+        w = std::fmod(w, 2.0);
+        return (w > 1.0) ? 2.0 - w : w;
+    }
+    return 0.0;
+}
+
 inline RGBA8 scene_object::get_color(const double x, const double y) const {
     return m_color->solve(x, y);
 }
@@ -0,0 +1,29 @@
+#ifndef HADRYAN_SEGMENT_REF_H
+#define HADRYAN_SEGMENT_REF_H
+
+#include <cstdint>
+
+namespace hadryan {
+
+// A cell refers to a segment of an object by its index in the path of
+// the object, with the top bit set when the shortcut of the segment
+// crosses the cell.
+typedef uint32_t segment_ref;
+
+constexpr segment_ref shortcut_flag = 0x80000000u;
+
+inline segment_ref make_segment_ref(uint32_t index, bool shortcut) {
+    return shortcut ? (index | shortcut_flag) : index;
+}
+
+inline uint32_t segment_index(segment_ref ref) {
+    return ref & ~shortcut_flag;
+}
+
+inline bool is_shortcut(segment_ref ref) {
+    return (ref & shortcut_flag) != 0;
+}
+
+} // hadryan
+
+#endif // HADRYAN_SEGMENT_REF_H
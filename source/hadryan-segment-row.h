@@ -0,0 +1,32 @@
+#ifndef HADRYAN_SEGMENT_ROW_H
+#define HADRYAN_SEGMENT_ROW_H
+
+namespace hadryan {
+
+// A segment written out as a row of doubles, for the non-virtual
+// winding loops of segment_store and of the sample lane kernels.
+struct segment_row {
+    enum e_kind { linear_kind, quadratic_kind, cubic_kind, shortcut_kind, n_kinds };
+    // columns of every segment type: bounding box, first end point
+    // and direction, followed by those of the type
+    enum e_column { x0, y0, x1, y1, px, py, dir, n_common };
+    enum e_linear_column { dx = n_common, dy, n_linear };
+    // the diagonal to the last control point and the implicit quadric
+    enum e_quadratic_column { qx = n_common, qy, qa, qb, qc, qd, qe, qder, qcvx,
+        n_quadratic };
+    // inner and last vertices of the bounding triangle and the implicit cubic
+    enum e_cubic_column { vx = n_common, vy, wx, wy, ca, cb, cc, cd, ce, cf, cg,
+        ch, ci, cder, n_cubic };
+    // right end point of a segment leaving through the right side
+    enum e_shortcut_column { rx, ry, sh_dir, n_shortcut };
+    static constexpr int max_width = n_cubic;
+    // columns of a row of kind
+    static constexpr int width(int kind) {
+        return kind == linear_kind ? (int) n_linear : kind == quadratic_kind ?
+            (int) n_quadratic : kind == cubic_kind ? (int) n_cubic : (int) n_shortcut;
+    }
+};
+
+} // hadryan
+
+#endif // HADRYAN_SEGMENT_ROW_H
@@ -0,0 +1,179 @@
+#include "hadryan-segment-store.h"
+
+#include "hadryan-winding.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+void segment_store::add(const path_segment &seg) {
+    double row[max_width];
+    int kind = seg.get_row(row);
+    m_rows[kind].insert(m_rows[kind].end(), row, row + width(kind));
+    m_size[kind]++;
+}
+
+void segment_store::add_shortcut(const path_segment &seg) {
+    std::vector<double> &rows = m_rows[shortcut_kind];
+    m_size[shortcut_kind]++;
+    rows.push_back(seg.right()[0]);
+    rows.push_back(seg.right()[1]);
+    rows.push_back(seg.get_sh_dir());
+}
+
+// column c of kind starts at c*m_size[kind] of its block
+void segment_store::finish(bool single) {
+    m_single = single;
+    for(int k = 0; k < n_kinds; k++) {
+        int row_width = width(k);
+        uint32_t n = m_size[k];
+        std::vector<double> &columns = m_columns[k];
+        columns.assign((size_t) row_width*n, 0.0);
+        for(uint32_t i = 0; i < n; i++) {
+            for(int c = 0; c < row_width; c++) {
+                columns[(size_t) c*n + i] = m_rows[k][(size_t) i*row_width + c];
+            }
+        }
+        std::vector<double>().swap(m_rows[k]);
+        if(single) {
+            m_single_columns[k].assign(columns.begin(), columns.end());
+            m_single_safe[k].resize(n);
+            for(uint32_t i = 0; i < n; i++) {
+                m_single_safe[k][i] = lane_kernels::single_safe(k, &columns[i], n);
+            }
+        }
+    }
+}
+
+size_t segment_store::get_reserved() const {
+    size_t bytes = 0;
+    for(int k = 0; k < n_kinds; k++) {
+        bytes += m_columns[k].capacity()*sizeof(double)
+            + m_single_columns[k].capacity()*sizeof(float)
+            + m_single_safe[k].capacity();
+    }
+    return bytes;
+}
+
+// The kernels make the tests of path_segment::intersect and of each
+// implicit_hit in the same order, so they give the same answers as
+// the virtual calls.
+
+int segment_store::linear_winding(uint32_t begin, uint32_t size, double x,
+    double y) const {
+    const uint32_t n = m_size[linear_kind];
+    const double* c = m_columns[linear_kind].data() + begin;
+    int sum = 0;
+    for(uint32_t i = 0; i < size; i++) {
+        if((y < c[y1*n+i]) & (x <= c[x1*n+i]) & (y >= c[y0*n+i])) {
+            double ddx = c[dx*n+i];
+            double ddy = c[dy*n+i];
+            if((x <= c[x0*n+i]) | (ddy*((x - c[px*n+i])*ddy - (y - c[py*n+i])*ddx) <= 0)) {
+                sum += (int) c[dir*n+i];
+            }
+        }
+    }
+    return sum;
+}
+
+int segment_store::quadratic_winding(uint32_t begin, uint32_t size, double x,
+    double y) const {
+    const uint32_t n = m_size[quadratic_kind];
+    const double* c = m_columns[quadratic_kind].data() + begin;
+    int sum = 0;
+    for(uint32_t i = 0; i < size; i++) {
+        if(!((y < c[y1*n+i]) & (x <= c[x1*n+i]) & (y >= c[y0*n+i]))) {
+            continue;
+        }
+        if(x <= c[x0*n+i]) {
+            sum += (int) c[dir*n+i];
+            continue;
+        }
+        double lx = x - c[px*n+i];
+        double ly = y - c[py*n+i];
+        bool diag = c[qy*n+i]*(lx*c[qy*n+i] - ly*c[qx*n+i]) <= 0;
+        bool me = c[qder*n+i]*((ly*(ly*c[qa*n+i] + c[qb*n+i])
+            + lx*(c[qc*n+i] + ly*c[qd*n+i] + lx*c[qe*n+i]))) <= 0;
+        if(c[qcvx*n+i] != 0 ? (diag & me) : (diag | me)) {
+            sum += (int) c[dir*n+i];
+        }
+    }
+    return sum;
+}
+
+int segment_store::cubic_winding(uint32_t begin, uint32_t size, double x,
+    double y) const {
+    const uint32_t n = m_size[cubic_kind];
+    const double* c = m_columns[cubic_kind].data() + begin;
+    int sum = 0;
+    for(uint32_t i = 0; i < size; i++) {
+        if(!((y < c[y1*n+i]) & (x <= c[x1*n+i]) & (y >= c[y0*n+i]))) {
+            continue;
+        }
+        if(x <= c[x0*n+i]) {
+            sum += (int) c[dir*n+i];
+            continue;
+        }
+        double lx = x - c[px*n+i];
+        double ly = y - c[py*n+i];
+        double vvx = c[vx*n+i];
+        double vvy = c[vy*n+i];
+        double wwx = c[wx*n+i];
+        double wwy = c[wy*n+i];
+        int hits = linear_intersect(0.0, 0.0, vvx, vvy, lx, ly)
+            + linear_intersect(vvx, vvy, wwx, wwy, lx, ly)
+            + linear_intersect(wwx, wwy, 0.0, 0.0, lx, ly);
+        if(hits == 2 || (hits == 1 && (c[cder*n+i]*(ly*(c[ca*n+i]
+            + ly*(ly*(c[cb*n+i]) + c[cc*n+i])) + lx*(c[cd*n+i] + ly*(c[ce*n+i]
+            + ly*c[cf*n+i]) + lx*(c[cg*n+i] + ly*c[ch*n+i] + lx*c[ci*n+i])))) <= 0)) {
+            sum += (int) c[dir*n+i];
+        }
+    }
+    return sum;
+}
+
+int segment_store::shortcut_winding(uint32_t begin, uint32_t size, double x,
+    double y) const {
+    const uint32_t n = m_size[shortcut_kind];
+    const double* c = m_columns[shortcut_kind].data() + begin;
+    int sum = 0;
+    for(uint32_t i = 0; i < size; i++) {
+        sum += ((x < c[rx*n+i]) & (y >= c[ry*n+i])) ? (int) c[sh_dir*n+i] : 0;
+    }
+    return sum;
+}
+
+// the rows of a run are read in place, a column block apart, in float
+// when the kernels and the row allow it
+uint64_t segment_store::hit_lanes(const scene_object* obj, int increment,
+    const ranges &r, const sample_lanes &lanes, uint64_t open,
+    const lane_kernels &k) const {
+    open = lanes.inside(obj->get_bbox(), open);
+    if(open == 0) {
+        return 0;
+    }
+    int32_t sum[sample_lanes::max_lanes];
+    std::fill(sum, sum + lanes.n, increment);
+    for(int kind = 0; kind < n_kinds; kind++) {
+        const size_t stride = m_size[kind];
+        const uint32_t begin = r.begin[kind];
+        const double* row = m_columns[kind].data() + begin;
+        const bool single = m_single && k.single[kind] != nullptr;
+        for(uint32_t i = 0; i < r.size[kind]; i++) {
+            bool miss = kind == shortcut_kind ? lanes.miss_shortcut(row + i, stride)
+                : lanes.miss_segment(row + i, stride);
+            if(miss) {
+                continue;
+            }
+            if(single && m_single_safe[kind][begin + i]) {
+                k.single[kind](m_single_columns[kind].data() + begin + i, stride,
+                    lanes, sum);
+            } else {
+                k.kernel[kind](row + i, stride, lanes, sum);
+            }
+        }
+    }
+    return winding_rule_lanes(obj, sum, open);
+}
+
+} // hadryan
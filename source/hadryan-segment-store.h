@@ -0,0 +1,109 @@
+#ifndef HADRYAN_SEGMENT_STORE_H
+#define HADRYAN_SEGMENT_STORE_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "hadryan-path-segment.h"
+#include "hadryan-scene-object.h"
+#include "hadryan-segment-row.h"
+#include "hadryan-sample-lanes.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+// Segments of a flat_tree copied by value into a structure of arrays
+// per segment type. The segments of a cell object are a contiguous
+// run of each array, so its winding test is one loop per type over
+// the coefficients, with no virtual call and no pointer chasing.
+// Segments are added a row at a time, and finish transposes the rows
+// into one block of columns per type, also in float for single
+// precision lanes.
+class segment_store : public segment_row {
+public:
+    // runs of one cell object in each array
+    struct ranges {
+        uint32_t begin[n_kinds];
+        uint32_t size[n_kinds];
+    };
+private:
+    std::vector<double> m_rows[n_kinds];
+    std::vector<double> m_columns[n_kinds];
+    // the columns rounded to float, and whether single precision lanes
+    // may test each row in float, when finish is asked for them
+    std::vector<float> m_single_columns[n_kinds];
+    std::vector<uint8_t> m_single_safe[n_kinds];
+    uint32_t m_size[n_kinds] = { 0, 0, 0, 0 };
+    bool m_single = false;
+
+    int linear_winding(uint32_t begin, uint32_t size, double x, double y) const;
+    int quadratic_winding(uint32_t begin, uint32_t size, double x, double y) const;
+    int cubic_winding(uint32_t begin, uint32_t size, double x, double y) const;
+    int shortcut_winding(uint32_t begin, uint32_t size, double x, double y) const;
+public:
+    void add(const path_segment &seg);
+    void add_shortcut(const path_segment &seg);
+    ranges begin_ranges() const;
+    void end_ranges(ranges &r) const;
+    void finish(bool single = false);
+    size_t get_reserved() const;
+    bool hit(const scene_object* obj, int increment, const ranges &r,
+        const double x, const double y) const;
+    uint64_t hit_lanes(const scene_object* obj, int increment, const ranges &r,
+        const sample_lanes &lanes, uint64_t open, const lane_kernels &k) const;
+};
+
+// runs starting at the end of each array, for the segments added next
+inline segment_store::ranges segment_store::begin_ranges() const {
+    ranges r;
+    for(int k = 0; k < n_kinds; k++) {
+        r.begin[k] = m_size[k];
+        r.size[k] = 0;
+    }
+    return r;
+}
+
+inline void segment_store::end_ranges(ranges &r) const {
+    for(int k = 0; k < n_kinds; k++) {
+        r.size[k] = m_size[k] - r.begin[k];
+    }
+}
+
+// path_segment::intersect of a linear segment from p to q, written
+// out so loops over it need no segment object
+template <typename T>
+inline bool linear_intersect(T px, T py, T qx, T qy, T x, T y) {
+    T dx = qx - px;
+    T dy = qy - py;
+    bool inside = (y < std::max(py, qy)) & (x <= std::max(px, qx))
+        & (y >= std::min(py, qy));
+    bool left = (x <= std::min(px, qx)) | (dy*((x - px)*dy - (y - py)*dx) <= 0);
+    return inside & left;
+}
+
+inline bool segment_store::hit(const scene_object* obj, int increment,
+    const ranges &r, const double x, const double y) const {
+    if(!obj->get_bbox().hit_inside(x, y)) {
+        return false;
+    }
+    int sum = increment;
+    if(r.size[linear_kind]) {
+        sum += linear_winding(r.begin[linear_kind], r.size[linear_kind], x, y);
+    }
+    if(r.size[quadratic_kind]) {
+        sum += quadratic_winding(r.begin[quadratic_kind], r.size[quadratic_kind], x, y);
+    }
+    if(r.size[cubic_kind]) {
+        sum += cubic_winding(r.begin[cubic_kind], r.size[cubic_kind], x, y);
+    }
+    if(r.size[shortcut_kind]) {
+        sum += shortcut_winding(r.begin[shortcut_kind], r.size[shortcut_kind], x, y);
+    }
+    return obj->satisfy_wrule(sum);
+}
+
+} // hadryan
+
+#endif // HADRYAN_SEGMENT_STORE_H
@@ -0,0 +1,29 @@
+#ifndef HADRYAN_SIMD_TARGET_H
+#define HADRYAN_SIMD_TARGET_H
+
+// Functions marked with these are compiled for instruction sets wider
+// than the ones the makefile builds for. They are only called once
+// cpu_has_avx2 or cpu_has_avx512 tells the processor runs them.
+#if defined(__x86_64__) || defined(__i386__)
+
+#define HADRYAN_X86
+#define HADRYAN_AVX2 __attribute__((target("avx2")))
+#define HADRYAN_AVX512 __attribute__((target("avx512f,prefer-vector-width=512")))
+
+namespace hadryan {
+
+inline bool cpu_has_avx2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+
+inline bool cpu_has_avx512() {
+    static const bool has = __builtin_cpu_supports("avx512f");
+    return has;
+}
+
+} // hadryan
+
+#endif
+
+#endif // HADRYAN_SIMD_TARGET_H
@@ -0,0 +1,42 @@
+#ifndef HADRYAN_TASK_REPORT_H
+#define HADRYAN_TASK_REPORT_H
+
+#include <vector>
+#include <cstdio>
+#include <omp.h>
+
+namespace hadryan {
+
+// Child cells each thread subdivided as OpenMP tasks, and child cells
+// it subdivided inline because they fell below the task cutoff. Each
+// thread only touches its own counters.
+class task_report {
+    std::vector<long> m_tasks;
+    std::vector<long> m_inline;
+public:
+    task_report(int threads)
+        : m_tasks(threads, 0)
+        , m_inline(threads, 0)
+    {}
+    void add_task() {
+        m_tasks[omp_get_thread_num()]++;
+    }
+    void add_inline() {
+        m_inline[omp_get_thread_num()]++;
+    }
+    void print(FILE *out) const {
+        long tasks = 0;
+        long inlined = 0;
+        for(int t = 0; t < (int) m_tasks.size(); t++) {
+            fprintf(out, "subdivide thread %d: %ld tasks %ld inline\n",
+                t, m_tasks[t], m_inline[t]);
+            tasks += m_tasks[t];
+            inlined += m_inline[t];
+        }
+        fprintf(out, "subdivide %ld tasks %ld inline\n", tasks, inlined);
+    }
+};
+
+} // hadryan
+
+#endif // HADRYAN_TASK_REPORT_H
@@ -28,4 +28,8 @@ RGBA8 texture_solver::solve(double x, double y) const {
     return color;
 }
 
+color_solver* texture_solver::clone() const {
+    return new texture_solver(*this);
+}
+
 } // hadryan
\ No newline at end of file
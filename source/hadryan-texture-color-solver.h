@@ -14,6 +14,7 @@ private:
     const int m_w, m_h;
 public:
     texture_solver(const paint &pat);
+    color_solver* clone() const;
     RGBA8 solve(double x, double y) const;
 };
 
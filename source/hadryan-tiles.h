@@ -0,0 +1,103 @@
+#ifndef HADRYAN_TILES_H
+#define HADRYAN_TILES_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <omp.h>
+
+using namespace rvg;
+
+namespace hadryan {
+
+// rectangle of image pixels rendered as one unit of work
+struct tile {
+    int x0, y0;
+    int x1, y1;
+    double cost;
+};
+
+// Splits a width x height image into size x size tiles, in decreasing
+// order of their cost estimated from the leaves they overlap, so the
+// dynamic schedule hands out the expensive ones first and the cheap
+// ones fill in at the end.
+template <typename LEAF>
+std::vector<tile> make_tiles(const std::vector<const LEAF*> &leaves,
+    int xl, int yb, int width, int height, int size) {
+    int nx = (width+size-1)/size;
+    int ny = (height+size-1)/size;
+    std::vector<tile> tiles(nx*ny);
+    for(int ty = 0; ty < ny; ty++) {
+        for(int tx = 0; tx < nx; tx++) {
+            tile &t = tiles[ty*nx + tx];
+            t.x0 = tx*size;
+            t.y0 = ty*size;
+            t.x1 = std::min(t.x0 + size, width);
+            t.y1 = std::min(t.y0 + size, height);
+            t.cost = (t.x1-t.x0)*(t.y1-t.y0);
+        }
+    }
+    for(auto nod : leaves) {
+        // cost of a sample in the leaf
+        double cost = 0;
+        for(auto &obj : nod->get_objects()) {
+            cost += 1 + obj.get_size();
+        }
+        int x0 = std::max((int) nod->get_p0()[0] - xl, 0);
+        int y0 = std::max((int) nod->get_p0()[1] - yb, 0);
+        int x1 = std::min((int) nod->get_p1()[0] - xl, width);
+        int y1 = std::min((int) nod->get_p1()[1] - yb, height);
+        for(int ty = y0/size; ty*size < y1; ty++) {
+            for(int tx = x0/size; tx*size < x1; tx++) {
+                tile &t = tiles[ty*nx + tx];
+                int w = std::min(t.x1, x1) - std::max(t.x0, x0);
+                int h = std::min(t.y1, y1) - std::max(t.y0, y0);
+                if(w > 0 && h > 0) {
+                    t.cost += cost*w*h;
+                }
+            }
+        }
+    }
+    std::stable_sort(tiles.begin(), tiles.end(), [](const tile &a, const tile &b) {
+        return a.cost > b.cost;
+    });
+    return tiles;
+}
+
+// time each thread spent on work items against the wall time of the
+// parallel region
+class thread_report {
+    std::vector<double> m_busy;
+    std::vector<int> m_items;
+    double m_start;
+    double m_wall;
+public:
+    thread_report(int threads)
+        : m_busy(threads, 0.0)
+        , m_items(threads, 0)
+        , m_start(omp_get_wtime())
+        , m_wall(0.0)
+    {}
+    void add(double busy) {
+        int t = omp_get_thread_num();
+        m_busy[t] += busy;
+        m_items[t]++;
+    }
+    void stop() {
+        m_wall = omp_get_wtime() - m_start;
+    }
+    void print(FILE *out, const char *what) const {
+        double total = 0.0;
+        for(int t = 0; t < (int) m_busy.size(); t++) {
+            fprintf(out, "%s thread %d: %d items busy %.3fs idle %.3fs\n", what,
+                t, m_items[t], m_busy[t], std::max(m_wall - m_busy[t], 0.0));
+            total += m_busy[t];
+        }
+        fprintf(out, "%s wall %.3fs efficiency %.1f%%\n", what, m_wall,
+            m_wall > 0 ? 100.0*total/(m_wall*m_busy.size()) : 100.0);
+    }
+};
+
+} // hadryan
+
+#endif // HADRYAN_TILES_H
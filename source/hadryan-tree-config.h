@@ -0,0 +1,69 @@
+#ifndef HADRYAN_TREE_CONFIG_H
+#define HADRYAN_TREE_CONFIG_H
+
+using namespace rvg;
+
+namespace hadryan {
+
+enum class e_accel_mode {
+    tree, // shortcut tree
+    grid  // regular grid of equal cells
+};
+
+enum class e_tree_layout {
+    pointer, // intern_node and leave_node objects linked by pointers
+    flat     // flat_tree arrays in Morton order
+};
+
+enum class e_store_mode {
+    objects, // winding tests call the virtual segments of the scene objects
+    soa      // flat_tree leaves copy their segments into a segment_store
+};
+
+enum class e_split_mode {
+    fixed, // split down to max_depth while cells have min_segments
+    cost   // split only when the expected cost per sample goes down
+};
+
+enum class e_build_mode {
+    eager, // subdivide the whole tree before rendering
+    lazy   // subdivide each leaf the first time a sample lands in it
+};
+
+// Parameters of one tree build. Each accelerated owns its own, and
+// subdivision receives it, so scenes with different settings can be
+// built at the same time.
+class tree_config {
+public:
+    int max_depth;
+    int min_segments;
+    e_tree_layout layout;
+    e_store_mode store;
+    e_split_mode split;
+    e_build_mode build;
+    // children deeper than task_depth, or with fewer than task_segments
+    // segments, are subdivided inline instead of as OpenMP tasks
+    int task_depth;
+    int task_segments;
+    e_accel_mode accel;
+    int grid_size; // pixels per side of a grid cell, 0 picks it from the segments
+public:
+    tree_config();
+};
+
+inline tree_config::tree_config()
+    : max_depth(2)
+    , min_segments(1)
+    , layout(e_tree_layout::pointer)
+    , store(e_store_mode::objects)
+    , split(e_split_mode::fixed)
+    , build(e_build_mode::eager)
+    , task_depth(6)
+    , task_segments(64)
+    , accel(e_accel_mode::tree)
+    , grid_size(0)
+{}
+
+} // hadryan
+
+#endif // HADRYAN_TREE_CONFIG_H
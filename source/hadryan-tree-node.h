@@ -1,6 +1,9 @@
 #ifndef HADRYAN_TREE_NODE_H
 #define HADRYAN_TREE_NODE_H
 
+#include <vector>
+#include <cstdint>
+
 #include "hadryan-bouding-box.h"
 
 using namespace rvg;
@@ -8,34 +11,58 @@ using namespace rvg;
 namespace hadryan {
 
 class leave_node;
+class flat_tree;
 
 class tree_node {
 protected:
-    static int max_depth;
-    static int min_segments;
-    const double m_w;
-    const double m_h;
-    const bouding_box m_bbox;
-    const R2 m_pc;
-    const R2 m_p0;
-    const R2 m_p1;
+    // corners of the cell, on the integer grid; everything else about
+    // it is derived, which keeps the nodes of deep trees small
+    const int32_t m_x0;
+    const int32_t m_y0;
+    const int32_t m_x1;
+    const int32_t m_y1;
+    R2 get_pc() const;
+    double get_area() const;
+    bouding_box get_bbox() const;
 public:
     tree_node(const R2 &p0, const R2 &p1);
     virtual ~tree_node() = default;
     bool intersect(const bouding_box& bbox) const;
-    virtual void destroy() {}
     bool is_in_cell(const double &x, const double &y) const;
-    static void set_max_depth(int max_);
-    static void set_min_segments(int min_);  
+    R2 get_p0() const;
+    R2 get_p1() const;
     virtual const leave_node* get_node_of(const double &x, const double &y) const = 0;
+    virtual void get_leaves(std::vector<const leave_node*> &leaves) const = 0;
+    virtual void flatten(flat_tree &tree, int index) const = 0;
 };
 
+// the split point, rounded down to the grid
+inline R2 tree_node::get_pc() const {
+    return make_R2(m_x0 + (m_x1-m_x0)/2, m_y0 + (m_y1-m_y0)/2);
+}
+
+inline double tree_node::get_area() const {
+    return (double) (m_x1-m_x0)*(m_y1-m_y0);
+}
+
+inline bouding_box tree_node::get_bbox() const {
+    return bouding_box(get_p0(), get_p1());
+}
+
 inline bool tree_node::intersect(const bouding_box& bbox) const {
-    return m_bbox.intersect(bbox);
+    return get_bbox().intersect(bbox);
 }
 
 inline bool tree_node::is_in_cell(const double &x, const double &y) const {
-    return x >= (double) m_p0[0] && x < (double) m_p1[0] && y >= (double) m_p0[1] && y < (double) m_p1[1];
+    return x >= m_x0 && x < m_x1 && y >= m_y0 && y < m_y1;
+}
+
+inline R2 tree_node::get_p0() const {
+    return make_R2(m_x0, m_y0);
+}
+
+inline R2 tree_node::get_p1() const {
+    return make_R2(m_x1, m_y1);
 }
 
 } // hadryan
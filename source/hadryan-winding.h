@@ -0,0 +1,437 @@
+#ifndef HADRYAN_WINDING_H
+#define HADRYAN_WINDING_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+#include "hadryan-path-segment.h"
+#include "hadryan-scene-object.h"
+#include "hadryan-segment-ref.h"
+#include "hadryan-sample-lanes.h"
+
+using namespace rvg;
+
+namespace hadryan {
+
+// Winding tests shared by every cell layout. A cell keeps, for each
+// object, a contiguous array of segment_refs into the path of the
+// object: the segments crossing the cell, followed by the segments
+// whose shortcut crosses it.
+
+inline bool winding_hit(const scene_object* obj, int increment, 
+    const segment_ref* refs, int n_refs, const double x, const double y) {
+    if(!obj->get_bbox().hit_inside(x, y)) {
+        return false;
+    }
+    const path_segment* const* path = obj->get_path().data();
+    int sum = increment;
+    for(int i = 0; i < n_refs; i++) {
+        const path_segment* seg = path[segment_index(refs[i])];
+        if(seg->intersect(x, y)) {
+            sum += seg->get_dir();
+        }
+        if(is_shortcut(refs[i]) && seg->intersect_shortcut(x, y)) {
+            sum += seg->get_sh_dir();
+        }
+    }
+    return obj->satisfy_wrule(sum);
+}
+
+// Lane versions of winding_hit, giving the mask of the open lanes the
+// object covers. A segment is written out as a segment_row only when
+// its bounding box can hold a lane.
+
+inline void segment_lanes(const path_segment* seg, const sample_lanes &lanes,
+    const lane_kernels &k, int32_t* sum) {
+    const R2 &b0 = seg->m_bbox.get_p0();
+    const R2 &b1 = seg->m_bbox.get_p1();
+    if(lanes.y0 >= b1[1] || lanes.x0 > b1[0] || lanes.y1 < b0[1]) {
+        return;
+    }
+    double row[segment_row::max_width];
+    int kind = seg->get_row(row);
+    k.kernel[kind](row, 1, lanes, sum);
+}
+
+inline void shortcut_lanes(const path_segment* sh, const sample_lanes &lanes,
+    const lane_kernels &k, int32_t* sum) {
+    R2 r(sh->right());
+    double row[segment_row::n_shortcut] = { r[0], r[1], (double) sh->get_sh_dir() };
+    if(!lanes.miss_shortcut(row, 1)) {
+        k.kernel[segment_row::shortcut_kind](row, 1, lanes, sum);
+    }
+}
+
+inline uint64_t winding_rule_lanes(const scene_object* obj, const int32_t* sum,
+    uint64_t open) {
+    uint64_t mask = 0;
+    for(uint64_t m = open; m != 0; m &= m - 1) {
+        int i = __builtin_ctzll(m);
+        mask |= (uint64_t) obj->satisfy_wrule(sum[i]) << i;
+    }
+    return mask;
+}
+
+inline uint64_t winding_lanes(const scene_object* obj, int increment,
+    const segment_ref* refs, int n_refs, const sample_lanes &lanes,
+    uint64_t open, const lane_kernels &k) {
+    open = lanes.inside(obj->get_bbox(), open);
+    if(open == 0) {
+        return 0;
+    }
+    const path_segment* const* path = obj->get_path().data();
+    int32_t sum[sample_lanes::max_lanes];
+    std::fill(sum, sum + lanes.n, increment);
+    for(int i = 0; i < n_refs; i++) {
+        const path_segment* seg = path[segment_index(refs[i])];
+        segment_lanes(seg, lanes, k, sum);
+        if(is_shortcut(refs[i])) {
+            shortcut_lanes(seg, lanes, k, sum);
+        }
+    }
+    return winding_rule_lanes(obj, sum, open);
+}
+
+// Winding number integrated over an area, as the area where each
+// intersect and intersect_shortcut holds. The integral stands for the
+// coverage only while the winding takes two consecutive values, as it
+// does around an edge or a vertex. winding_cover gives the fraction of
+// area the object covers, and false when a curve crosses area along
+// with another edge, as only lines have an exact area and position,
+// or when the edges inside area may step the winding to a third value.
+
+// A part of area where a segment or a shortcut adds dir to the
+// winding: each row between y0 and y1 from its left end up to the
+// line x = px + (y - py)*k. exact is false for a curve, whose left
+// side has no such line.
+struct cover_edge {
+    double y0, y1;
+    double px, py, k;
+    int dir;
+    bool exact;
+
+    double width(double y, const bouding_box &area) const {
+        if(y < y0 || y >= y1) {
+            return 0.0;
+        }
+        const R2 &a0 = area.get_p0();
+        const R2 &a1 = area.get_p1();
+        return std::min(std::max(px + (y - py)*k, (double) a0[0]), (double) a1[0]) - a0[0];
+    }
+};
+
+// Two edges keep the winding on two consecutive values when they step
+// it in the same direction over parts of area apart, as the sides of
+// a vertex, or in opposite directions over parts one inside the
+// other, as the sides of a sliver or a wedge. Between the rows where
+// either edge ends, meets a side of area or meets the other, both
+// widths are linear and keep their order, so one row of each stretch
+// tells.
+inline bool cover_pair(const cover_edge &a, const cover_edge &b, const bouding_box &area) {
+    if(!a.exact || !b.exact) {
+        return false;
+    }
+    const R2 &a0 = area.get_p0();
+    const R2 &a1 = area.get_p1();
+    double ys[10] = { a0[1], a1[1], a.y0, a.y1, b.y0, b.y1 };
+    int n = 6;
+    for(const cover_edge* e : {&a, &b}) {
+        if(e->k != 0.0) {
+            ys[n++] = e->py + (a0[0] - e->px)/e->k;
+            ys[n++] = e->py + (a1[0] - e->px)/e->k;
+        }
+    }
+    if(a.k != b.k) {
+        ys[n++] = (b.px - a.px + a.py*a.k - b.py*b.k)/(a.k - b.k);
+    }
+    for(int i = 0; i < n; i++) {
+        ys[i] = std::min(std::max(ys[i], (double) a0[1]), (double) a1[1]);
+    }
+    std::sort(ys, ys + n);
+    bool apart = true, a_in_b = true, b_in_a = true;
+    for(int i = 0; i+1 < n; i++) {
+        if(ys[i] == ys[i+1]) {
+            continue;
+        }
+        double y = 0.5*(ys[i] + ys[i+1]);
+        double wa = a.width(y, area), wb = b.width(y, area);
+        apart = apart && std::min(wa, wb) == 0.0;
+        a_in_b = a_in_b && wa <= wb;
+        b_in_a = b_in_a && wb <= wa;
+    }
+    return a.dir == b.dir ? apart : a_in_b || b_in_a;
+}
+
+// The edges of the winding inside an area. A segment or shortcut on
+// the left of whole rows of area steps the winding along y where its
+// rows end, which the segments of a contour next to it mostly cancel,
+// so such steps are summed first, and what remains of them is one
+// more edge across the full width of area.
+class cover_edges {
+    static constexpr int max_edges = 2;
+    static constexpr int max_steps = 32;
+    cover_edge m_edge[max_edges];
+    int m_size = 0;
+    double m_step_y[max_steps];
+    int m_step_delta[max_steps];
+    int m_steps = 0;
+
+    bool add_edge(const cover_edge &e) {
+        if(m_size == max_edges) {
+            return false;
+        }
+        m_edge[m_size++] = e;
+        return true;
+    }
+
+    bool add_step(double y, int delta) {
+        if(m_steps == max_steps) {
+            return false;
+        }
+        m_step_y[m_steps] = y;
+        m_step_delta[m_steps] = delta;
+        m_steps++;
+        return true;
+    }
+
+    bool add_rows(double y0, double y1, int dir, const bouding_box &area) {
+        return (y0 <= area.get_p0()[1] || add_step(y0, dir)) &&
+            (y1 >= area.get_p1()[1] || add_step(y1, -dir));
+    }
+
+    // the steps that do not cancel, as at most one edge
+    bool add_steps(const bouding_box &area) {
+        double y[2];
+        int delta[2];
+        int n = 0;
+        for(int i = 0; i < m_steps; i++) {
+            int sum = 0;
+            bool first = true;
+            for(int j = 0; j < m_steps; j++) {
+                if(m_step_y[j] == m_step_y[i]) {
+                    sum += m_step_delta[j];
+                    first = first && j >= i;
+                }
+            }
+            if(sum != 0 && first) {
+                if(n == 2) {
+                    return false;
+                }
+                y[n] = m_step_y[i];
+                delta[n++] = sum;
+            }
+        }
+        if(n == 0) {
+            return true;
+        }
+        if(n == 2 && y[1] < y[0]) {
+            std::swap(y[0], y[1]);
+            std::swap(delta[0], delta[1]);
+        }
+        if(std::abs(delta[0]) != 1 || (n == 2 && delta[1] != -delta[0])) {
+            return false;
+        }
+        const R2 &a1 = area.get_p1();
+        return add_edge(cover_edge{y[0], n == 2 ? y[1] : a1[1], a1[0], 0.0, 0.0,
+            delta[0], true});
+    }
+
+public:
+    // a segment with left the part of area on its left
+    bool add_segment(const path_segment* seg, const bouding_box &area, double left) {
+        if(left == 0.0) {
+            return true;
+        }
+        const R2 &a0 = area.get_p0();
+        const R2 &a1 = area.get_p1();
+        double y0 = std::max(a0[1], seg->m_bbox.get_p0()[1]);
+        double y1 = std::min(a1[1], seg->m_bbox.get_p1()[1]);
+        if(left < (a1[0] - a0[0])*(y1 - y0)) {
+            R2 p = seg->first(), q = seg->last();
+            return add_edge(cover_edge{y0, y1, p[0], p[1], (q[0] - p[0])/(q[1] - p[1]),
+                seg->get_dir(), seg->get_cost() == 1.0});
+        }
+        return add_rows(y0, y1, seg->get_dir(), area);
+    }
+
+    // a shortcut with sh the part of area inside it
+    bool add_shortcut(const path_segment* seg, const bouding_box &area, double sh) {
+        if(sh == 0.0) {
+            return true;
+        }
+        const R2 &a1 = area.get_p1();
+        R2 r(seg->right());
+        double y0 = std::max((double) area.get_p0()[1], (double) r[1]);
+        if(r[0] < a1[0]) {
+            return add_edge(cover_edge{y0, a1[1], r[0], 0.0, 0.0, seg->get_sh_dir(), true});
+        }
+        return add_rows(y0, a1[1], seg->get_sh_dir(), area);
+    }
+
+    // true if the winding takes at most two consecutive values
+    bool consecutive(const bouding_box &area) {
+        if(!add_steps(area)) {
+            return false;
+        }
+        return m_size < 2 || cover_pair(m_edge[0], m_edge[1], area);
+    }
+};
+
+inline bool segment_area(const path_segment* seg, bool shortcut,
+    const bouding_box &area, double &sum, cover_edges &edges) {
+    double left;
+    if(!seg->left_area(area, left) || !edges.add_segment(seg, area, left)) {
+        return false;
+    }
+    sum += seg->get_dir()*left;
+    if(shortcut) {
+        double sh = seg->shortcut_area(area);
+        if(!edges.add_shortcut(seg, area, sh)) {
+            return false;
+        }
+        sum += seg->get_sh_dir()*sh;
+    }
+    return true;
+}
+
+// area clipped to the bounding box of obj, outside of which
+// winding_hit fails. The edges of the box step the winding to 0
+// without a segment to count, so the rule applies to the mean over
+// the clip alone, and the part of area outside it is uncovered.
+inline bouding_box cover_clip(const scene_object* obj, const bouding_box &area) {
+    const R2 &a0 = area.get_p0();
+    const R2 &a1 = area.get_p1();
+    const R2 &o0 = obj->get_bbox().get_p0();
+    const R2 &o1 = obj->get_bbox().get_p1();
+    return bouding_box(make_R2(std::max(a0[0], o0[0]), std::max(a0[1], o0[1])),
+        make_R2(std::min(a1[0], o1[0]), std::min(a1[1], o1[1])));
+}
+
+inline bool winding_cover(const scene_object* obj, int increment,
+    const segment_ref* refs, int n_refs, const bouding_box &area, double &cover) {
+    double inside = obj->get_bbox().overlap(area);
+    cover = 0.0;
+    if(inside == 0.0) {
+        return true;
+    }
+    bouding_box clip(cover_clip(obj, area));
+    const path_segment* const* path = obj->get_path().data();
+    double sum = increment*inside;
+    cover_edges edges;
+    for(int i = 0; i < n_refs; i++) {
+        if(!segment_area(path[segment_index(refs[i])], is_shortcut(refs[i]), clip, sum,
+            edges)) {
+            return false;
+        }
+    }
+    if(!edges.consecutive(clip)) {
+        return false;
+    }
+    cover = obj->cover_wrule(sum/inside)*inside/area.overlap(area);
+    return true;
+}
+
+// Winding number changes along y met by a pixel footprint that stays on
+// the left of a segment (or inside a shortcut column). Consecutive
+// segments of a contour share endpoints, so their steps cancel out.
+class winding_steps {
+    static constexpr int max_steps = 32;
+    double m_y[max_steps];
+    int m_delta[max_steps];
+    int m_size = 0;
+public:
+    bool add(double y, int delta) {
+        if(m_size == max_steps) {
+            return false;
+        }
+        m_y[m_size] = y;
+        m_delta[m_size] = delta;
+        m_size++;
+        return true;
+    }
+    bool balanced() const {
+        for(int i = 0; i < m_size; i++) {
+            int sum = 0;
+            for(int j = 0; j < m_size; j++) {
+                if(m_y[j] == m_y[i]) {
+                    sum += m_delta[j];
+                }
+            }
+            if(sum != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// false if intersect may vary inside area in any way other than a step along y
+inline bool segment_steps(const path_segment* seg, const bouding_box &area,
+    winding_steps &steps) {
+    const R2 &a0 = area.get_p0();
+    const R2 &a1 = area.get_p1();
+    const R2 &b0 = seg->m_bbox.get_p0();
+    const R2 &b1 = seg->m_bbox.get_p1();
+    if(a0[1] >= b1[1] || a1[1] < b0[1] || a0[0] > b1[0]) {
+        return true;
+    }
+    if(a1[0] > b0[0]) {
+        // the segment is monotonic, so inside its y range the side of
+        // the curve is constant over area when all corners agree
+        if(a0[1] < b0[1] || a1[1] >= b1[1]) {
+            return false;
+        }
+        bool hit = seg->intersect(a0[0], a0[1]);
+        return hit == seg->intersect(a1[0], a0[1])
+            && hit == seg->intersect(a0[0], a1[1])
+            && hit == seg->intersect(a1[0], a1[1]);
+    }
+    if(a0[1] < b0[1] && !steps.add(b0[1], seg->get_dir())) {
+        return false;
+    }
+    if(a1[1] >= b1[1] && !steps.add(b1[1], -seg->get_dir())) {
+        return false;
+    }
+    return true;
+}
+
+// false if intersect_shortcut may vary inside area in any way other than a step along y
+inline bool shortcut_steps(const path_segment* sh, const bouding_box &area,
+    winding_steps &steps) {
+    const R2 &a0 = area.get_p0();
+    const R2 &a1 = area.get_p1();
+    R2 r(sh->right());
+    if(a0[0] >= r[0] || a1[1] < r[1]) {
+        return true;
+    }
+    if(a1[0] >= r[0]) {
+        return false;
+    }
+    if(a0[1] < r[1] && !steps.add(r[1], sh->get_sh_dir())) {
+        return false;
+    }
+    return true;
+}
+
+// true if winding_hit gives the same answer for every point of area
+inline bool winding_constant(const scene_object* obj, 
+    const segment_ref* refs, int n_refs, const bouding_box &area) {
+    if(!obj->get_bbox().hit_inside_constant(area)) {
+        return false;
+    }
+    const path_segment* const* path = obj->get_path().data();
+    winding_steps steps;
+    for(int i = 0; i < n_refs; i++) {
+        const path_segment* seg = path[segment_index(refs[i])];
+        if(!segment_steps(seg, area, steps) 
+            || (is_shortcut(refs[i]) && !shortcut_steps(seg, area, steps))) {
+            return false;
+        }
+    }
+    return steps.balanced();
+}
+
+} // hadryan
+
+#endif // HADRYAN_WINDING_H
@@ -0,0 +1,147 @@
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include "rvg-unit-test.h"
+
+#include "hadryan-accelerated.h"
+#include "hadryan-scene-object.h"
+#include "hadryan-linear-path-segment.h"
+
+using namespace hadryan;
+
+// a square of side s with its lower left corner at (x, y)
+static std::shared_ptr<scene_object> make_square(double x, double y, double s) {
+    R2 p[] = {make_R2(x, y), make_R2(x+s, y), make_R2(x+s, y+s), make_R2(x, y+s)};
+    std::vector<path_segment*> path;
+    for(int i = 0; i < 4; i++) {
+        path.push_back(new hadryan::linear(p[i], p[(i+1)%4]));
+    }
+    return std::make_shared<scene_object>(path, e_winding_rule::non_zero,
+        paint(RGBA8(255, 0, 0, 255), unorm8(255)));
+}
+
+static bool at(const bouding_box &b, double x0, double y0, double x1, double y1) {
+    return b.get_p0() == make_R2(x0, y0) && b.get_p1() == make_R2(x1, y1);
+}
+
+static void make_prev(accelerated &prev, const scene_data::const_ptr &source) {
+    prev.source = source;
+    prev.xf = make_translation(0.25, 0.25);
+    prev.flatness = 0;
+    prev.threads = 1;
+    prev.objects.push_back(make_square(10.25, 10.25, 20));
+}
+
+static void make_next(accelerated &acc, const accelerated &prev, const xform &xf) {
+    acc.source = prev.source;
+    acc.xf = xf;
+    acc.flatness = prev.flatness;
+    acc.threads = 1;
+}
+
+// an lvalue prev keeps its objects as they were, the same transform
+// shares them, and a translation or scale copies them
+static void test_shared(void) {
+    scene_data::const_ptr source(new scene_data());
+    accelerated prev;
+    make_prev(prev, source);
+    scene_object* obj = prev.objects[0].get();
+    accelerated same;
+    make_next(same, prev, prev.xf);
+    unit_test(same.take_transformed(prev));
+    unit_test(same.objects[0].get() == obj);
+    accelerated moved;
+    make_next(moved, prev, make_translation(3.25, -1.75));
+    unit_test(moved.take_transformed(prev));
+    unit_test(moved.objects[0].get() != obj);
+    unit_test(at(moved.objects[0]->get_bbox(), 13.25, 8.25, 33.25, 28.25));
+    accelerated scaled;
+    make_next(scaled, prev, make_scaling(2, -1)*prev.xf);
+    unit_test(scaled.take_transformed(prev));
+    unit_test(scaled.objects[0].get() != obj);
+    unit_test(at(scaled.objects[0]->get_bbox(), 20.5, -30.25, 60.5, -10.25));
+    unit_test(prev.objects.size() == 1 && prev.objects[0].get() == obj);
+    unit_test(at(obj->get_bbox(), 10.25, 10.25, 30.25, 30.25));
+    unit_test(obj->get_path().size() == 4);
+}
+
+// an rvalue prev gives up its objects, which are moved in place when
+// no one else holds them
+static void test_released(void) {
+    scene_data::const_ptr source(new scene_data());
+    accelerated prev;
+    make_prev(prev, source);
+    scene_object* obj = prev.objects[0].get();
+    accelerated acc;
+    make_next(acc, prev, make_translation(-4.75, 2.25));
+    unit_test(acc.take_transformed(std::move(prev)));
+    unit_test(prev.objects.empty());
+    unit_test(acc.objects[0].get() == obj && acc.objects[0].use_count() == 1);
+    unit_test(at(obj->get_bbox(), 5.25, 12.25, 25.25, 32.25));
+    // still shared with the copy, so it is copied
+    accelerated copy;
+    make_next(copy, acc, acc.xf);
+    unit_test(copy.take_transformed(acc));
+    accelerated next;
+    make_next(next, acc, make_translation(0.25, 0.25));
+    unit_test(next.take_transformed(std::move(acc)));
+    unit_test(next.objects[0].get() != obj);
+    unit_test(at(obj->get_bbox(), 5.25, 12.25, 25.25, 32.25));
+    unit_test(at(next.objects[0]->get_bbox(), 10.25, 10.25, 30.25, 30.25));
+}
+
+// flattened objects move by any pan or flip, but a scale would scale
+// how far their lines are from the curves
+static void test_flattened(void) {
+    scene_data::const_ptr source(new scene_data());
+    accelerated prev;
+    make_prev(prev, source);
+    prev.flatness = 0.25;
+    accelerated pan;
+    make_next(pan, prev, make_translation(0.75, 0.25));
+    unit_test(pan.take_transformed(prev));
+    unit_test(at(pan.objects[0]->get_bbox(), 10.75, 10.25, 30.75, 30.25));
+    accelerated flipped;
+    make_next(flipped, prev, make_scaling(-1, 1)*prev.xf);
+    unit_test(flipped.take_transformed(prev));
+    unit_test(at(flipped.objects[0]->get_bbox(), -30.25, 10.25, -10.25, 30.25));
+    accelerated scaled;
+    make_next(scaled, prev, make_scaling(2, 2)*prev.xf);
+    unit_test(!scaled.take_transformed(prev));
+    unit_test(scaled.objects.empty());
+}
+
+// objects of another scene, a rotation, or a different flatness are
+// built again
+static void test_rejected(void) {
+    scene_data::const_ptr source(new scene_data());
+    accelerated prev;
+    make_prev(prev, source);
+    accelerated other;
+    make_next(other, prev, prev.xf);
+    other.source.reset(new scene_data());
+    unit_test(!other.take_transformed(prev));
+    accelerated none;
+    make_next(none, prev, prev.xf);
+    none.source.reset();
+    unit_test(!none.take_transformed(prev));
+    accelerated rotated;
+    make_next(rotated, prev, make_rotation(30)*prev.xf);
+    unit_test(!rotated.take_transformed(prev));
+    accelerated flat;
+    make_next(flat, prev, prev.xf);
+    flat.flatness = 0.25;
+    unit_test(!flat.take_transformed(prev));
+    unit_test(other.objects.empty() && none.objects.empty() &&
+        rotated.objects.empty() && flat.objects.empty());
+    unit_test(prev.objects.size() == 1);
+}
+
+int main(void) {
+    test_shared();
+    test_released();
+    test_flattened();
+    test_rejected();
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <vector>
+
+#include <omp.h>
+
+#include "rvg-unit-test.h"
+
+#include "hadryan-arena.h"
+
+using namespace hadryan;
+
+static bool aligned(const void* p, size_t align) {
+    return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+// allocations keep their alignment and do not overlap
+static void test_allocate(void) {
+    arena a(1);
+    char* c = static_cast<char*>(a.allocate(1, 1));
+    double* d = a.make<double>(1.5);
+    unit_test(aligned(d, alignof(double)) && *d == 1.5);
+    void* v = a.allocate(48, 64);
+    unit_test(aligned(v, 64));
+    unit_test(static_cast<void*>(c) != static_cast<void*>(d));
+    int values[] = {1, 2, 3};
+    int* copied = a.copy(values, 3);
+    unit_test(copied[0] == 1 && copied[1] == 2 && copied[2] == 3);
+    unit_test(a.copy(values, 0) == nullptr);
+    // larger than a chunk
+    char* big = static_cast<char*>(a.allocate(3 << 20, 16));
+    big[(3 << 20) - 1] = 1;
+    unit_test(a.get_reserved() >= (3u << 20));
+}
+
+// a rewind drops what followed the mark, and the space is handed out
+// again, also across chunks, without reserving more
+static void test_rewind(void) {
+    arena a(1);
+    a.allocate(100, 8);
+    arena::mark m = a.get_mark();
+    void* first = a.allocate(64, 8);
+    for(int i = 0; i < 8; i++) {
+        a.allocate(300 << 10, 8);
+    }
+    size_t reserved = a.get_reserved();
+    a.rewind(m);
+    unit_test(a.allocate(64, 8) == first);
+    for(int i = 0; i < 8; i++) {
+        a.allocate(300 << 10, 8);
+    }
+    unit_test(a.get_reserved() == reserved);
+    // a rewind to a mark taken before anything was allocated
+    arena b(1);
+    arena::mark empty = b.get_mark();
+    void* p = b.allocate(16, 8);
+    b.rewind(empty);
+    unit_test(b.allocate(16, 8) == p);
+}
+
+// each thread of the team fills its own allocations, which no other
+// thread overwrites
+static void test_threads(void) {
+    const int threads = 4;
+    const int n = 1000;
+    arena a(threads);
+    std::vector<std::vector<int*>> blocks(threads);
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        for(int i = 0; i < n; i++) {
+            int* p = a.make<int>(t*n + i);
+            blocks[t].push_back(p);
+        }
+    }
+    for(int t = 0; t < (int) blocks.size(); t++) {
+        for(int i = 0; i < (int) blocks[t].size(); i++) {
+            unit_test(*blocks[t][i] == t*n + i);
+        }
+    }
+}
+
+int main(void) {
+    test_allocate();
+    test_rewind();
+    test_threads();
+    return 0;
+}
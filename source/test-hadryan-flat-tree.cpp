@@ -0,0 +1,85 @@
+#include <vector>
+
+#include "rvg-unit-test.h"
+
+#include "hadryan-arena.h"
+#include "hadryan-intern-node.h"
+#include "hadryan-leave-node.h"
+#include "hadryan-flat-tree.h"
+
+using namespace hadryan;
+
+// an empty tree over p0, p1, split depth times, and the bottom left
+// child of each split one level deeper while extra lasts
+static tree_node* make_tree(const R2 &p0, const R2 &p1, int depth, int extra, arena &a) {
+    if(depth == 0 && extra == 0) {
+        leave_builder leaf;
+        leaf.reset(p0, p1);
+        return leaf.build(a);
+    }
+    R2 pc = make_R2((p0[0] + p1[0])/2, (p0[1] + p1[1])/2);
+    int d = depth > 0 ? depth-1 : 0;
+    tree_node* bl = make_tree(p0, pc, d, depth > 0 ? extra : extra-1, a);
+    tree_node* br = make_tree(make_R2(pc[0], p0[1]), make_R2(p1[0], pc[1]), d, 0, a);
+    tree_node* tl = make_tree(make_R2(p0[0], pc[1]), make_R2(pc[0], p1[1]), d, 0, a);
+    tree_node* tr = make_tree(pc, p1, d, 0, a);
+    return a.make<intern_node>(p0, p1, tr, tl, bl, br);
+}
+
+static bool same_cell(const flat_leaf* f, const leave_node* l) {
+    return f != nullptr && l != nullptr && f->get_p0() == l->get_p0()
+        && f->get_p1() == l->get_p1();
+}
+
+// A full tree two levels deep keeps its 16 leaves in Morton order:
+// the bits of a leaf index alternate between x and y, coarsest last.
+static void test_morton(void) {
+    arena a(1);
+    tree_node* root = make_tree(make_R2(0, 0), make_R2(64, 64), 2, 0, a);
+    flat_tree flat(root);
+    std::vector<const flat_leaf*> leaves;
+    flat.get_leaves(leaves);
+    unit_test(leaves.size() == 16);
+    for(int i = 0; i < 16; i++) {
+        double x = 32*((i >> 2) & 1) + 16*(i & 1);
+        double y = 32*((i >> 3) & 1) + 16*((i >> 1) & 1);
+        unit_test(leaves[i]->get_p0() == make_R2(x, y));
+        unit_test(leaves[i]->get_p1() == make_R2(x + 16, y + 16));
+    }
+}
+
+// An uneven tree is laid out depth first, so the leaves of a deeper
+// bottom left quadrant all come before its siblings, and every point
+// finds the leaf the pointer tree gives.
+static void test_layout(void) {
+    arena a(1);
+    tree_node* root = make_tree(make_R2(-8, 4), make_R2(56, 68), 1, 3, a);
+    flat_tree flat(root);
+    std::vector<const flat_leaf*> leaves;
+    flat.get_leaves(leaves);
+    // each extra level splits the bottom left leaf into four
+    unit_test(leaves.size() == 4 + 3*3);
+    for(int i = 0; i < 4; i++) {
+        unit_test(leaves[i]->get_p1()[0] - leaves[i]->get_p0()[0] == 4);
+    }
+    unit_test(leaves.back()->get_p0() == make_R2(24, 36));
+    for(size_t i = 1; i < leaves.size(); i++) {
+        double size0 = leaves[i-1]->get_p1()[0] - leaves[i-1]->get_p0()[0];
+        double size1 = leaves[i]->get_p1()[0] - leaves[i]->get_p0()[0];
+        unit_test(size0 <= size1);
+    }
+    for(double y = 4.25; y < 68; y += 0.5) {
+        for(double x = -7.75; x < 56; x += 0.5) {
+            unit_test(same_cell(flat.get_node_of(x, y), root->get_node_of(x, y)));
+        }
+    }
+    unit_test(flat.get_node_of(-8.25, 10) == nullptr);
+    unit_test(flat.get_node_of(10, 68) == nullptr);
+    unit_test(flat.get_node_of(56, 10) == nullptr);
+}
+
+int main(void) {
+    test_morton();
+    test_layout();
+    return 0;
+}
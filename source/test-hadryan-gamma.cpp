@@ -0,0 +1,51 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "rvg-unit-test.h"
+
+#include "hadryan-gamma.h"
+
+using namespace hadryan;
+
+// encode picks the vector instructions of the processor, which must
+// give the bytes encode_scalar gives, tails included
+static void check_encode(const std::vector<float> &linear) {
+    int n = linear.size();
+    std::vector<uint8_t> scalar(n), vector(n);
+    for(int m = 0; m <= n; m += (m < 64) ? 1 : 61) {
+        gamma_lut::encode_scalar(linear.data(), m, scalar.data());
+        gamma_lut::encode(linear.data(), m, vector.data());
+        for(int i = 0; i < m; i++) {
+            unit_test(scalar[i] == vector[i]);
+        }
+    }
+}
+
+int main(void) {
+    // every level of the table and the values half way between them,
+    // where the rounding decides
+    std::vector<float> levels;
+    for(int i = 0; i < gamma_lut::encode_size; i++) {
+        levels.push_back(i/(float) (gamma_lut::encode_size-1));
+        levels.push_back((i+0.5f)/(float) (gamma_lut::encode_size-1));
+    }
+    check_encode(levels);
+    // out of range values are clamped
+    check_encode({-1.f, -0.f, 0.f, 1.f, 1.0001f, 2.f, 1e30f, -1e30f,
+        -1.f, -0.f, 0.f, 1.f, 1.0001f, 2.f, 1e30f, -1e30f, 0.5f});
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> dist(-0.1f, 1.1f);
+    std::vector<float> random(4099);
+    for(auto &l : random) {
+        l = dist(gen);
+    }
+    check_encode(random);
+    uint8_t out[2];
+    gamma_lut::encode_scalar(levels.data(), 1, out);
+    unit_test(out[0] == 0);
+    float one = 1.f;
+    gamma_lut::encode(&one, 1, out);
+    unit_test(out[0] == 255);
+    return 0;
+}
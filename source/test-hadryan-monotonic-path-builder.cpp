@@ -0,0 +1,105 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "rvg-unit-test.h"
+#include "rvg-bezier.h"
+
+#include "hadryan-monotonic-path-builder.h"
+#include "hadryan-linear-path-segment.h"
+#include "test-hadryan-random.h"
+
+using namespace hadryan;
+
+static test_random rnd(25);
+
+static double segment_distance(const R2 &p0, const R2 &p1, const R2 &q) {
+    double dx = p1[0] - p0[0], dy = p1[1] - p0[1];
+    double qx = q[0] - p0[0], qy = q[1] - p0[1];
+    double t = std::min(std::max((qx*dx + qy*dy)/(dx*dx + dy*dy), 0.0), 1.0);
+    return std::hypot(qx - t*dx, qy - t*dy);
+}
+
+// the lines the builder made of a curve, which start and end with it
+static std::vector<const path_segment*> flattened(monotonic_builder &builder,
+    const R2 &first, const R2 &last) {
+    std::vector<const path_segment*> lines;
+    for(auto seg : builder.get()) {
+        unit_test(dynamic_cast<const hadryan::linear*>(seg) != nullptr);
+        lines.push_back(seg);
+    }
+    unit_test(!lines.empty());
+    unit_test(lines.front()->first() == path_segment::off_grid(first));
+    unit_test(lines.back()->last() == path_segment::off_grid(last));
+    for(size_t i = 1; i < lines.size(); i++) {
+        unit_test(lines[i-1]->last() == lines[i]->first());
+    }
+    return lines;
+}
+
+// every point of the curve is within tolerance of the lines, up to
+// the rounding of the points to rvgf
+template <typename F>
+static void check_error(const std::vector<const path_segment*> &lines, F curve,
+    double tolerance) {
+    for(int i = 0; i <= 2000; i++) {
+        R2 q = curve(i/2000.0);
+        double d = 1e30;
+        for(auto line : lines) {
+            d = std::min(d, segment_distance(line->first(), line->last(), q));
+        }
+        unit_test(d <= tolerance + 1e-4);
+    }
+}
+
+// quadratics, rational quadratics and cubics of 1 to 400 pixels stay
+// within the tolerance of the lines they become, which grow in number
+// as it shrinks; 0 keeps the curves
+static void test_flatten(void) {
+    for(double tolerance : {0.5, 0.25, 0.1, 0.01}) {
+        int curves = 0, lines = 0;
+        for(int t = 0; t < 300; t++) {
+            double size = std::pow(2.0, rnd.uniform(0, 8.6));
+            monotonic_builder builder(tolerance);
+            std::vector<R2> p = rnd.monotonic_points(t % 3 == 1 ? 4 : 3, size, 1);
+            if(t % 3 == 0) {
+                double w = rnd.uniform(0.25, 4);
+                builder.do_rational_quadratic_segment(p[0][0], p[0][1], w*p[1][0],
+                    w*p[1][1], w, p[2][0], p[2][1]);
+                auto B = std::make_tuple(make_R3(p[0][0], p[0][1], 1),
+                    make_R3(w*p[1][0], w*p[1][1], w), make_R3(p[2][0], p[2][1], 1));
+                check_error(flattened(builder, p[0], p[2]), [&](double u) {
+                    return project<R2>(bezier_evaluate_horner(B, u)); }, tolerance);
+            } else if(t % 3 == 1) {
+                builder.do_cubic_segment(p[0][0], p[0][1], p[1][0], p[1][1],
+                    p[2][0], p[2][1], p[3][0], p[3][1]);
+                auto B = std::make_tuple(p[0], p[1], p[2], p[3]);
+                check_error(flattened(builder, p[0], p[3]), [&](double u) {
+                    return bezier_evaluate_horner(B, u); }, tolerance);
+            } else {
+                builder.do_quadratic_segment(p[0][0], p[0][1], p[1][0], p[1][1],
+                    p[2][0], p[2][1]);
+                auto B = std::make_tuple(p[0], p[1], p[2]);
+                check_error(flattened(builder, p[0], p[2]), [&](double u) {
+                    return bezier_evaluate_horner(B, u); }, tolerance);
+            }
+            curves += builder.get_curves();
+            lines += builder.get_lines();
+            unit_test(builder.get_lines() == (int) builder.get().size());
+            for(auto seg : builder.get()) {
+                delete seg;
+            }
+        }
+        unit_test(curves == 300 && lines > curves);
+    }
+    monotonic_builder keep(0.0);
+    keep.do_cubic_segment(0.5, 0.5, 10.5, 2.5, 20.5, 8.5, 30.5, 30.5);
+    unit_test(keep.get().size() == 1 && keep.get_curves() == 0);
+    unit_test(dynamic_cast<const hadryan::linear*>(keep.get()[0]) == nullptr);
+    delete keep.get()[0];
+}
+
+int main(void) {
+    test_flatten();
+    return 0;
+}
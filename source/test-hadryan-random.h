@@ -0,0 +1,51 @@
+#ifndef TEST_HADRYAN_RANDOM_H
+#define TEST_HADRYAN_RANDOM_H
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "hadryan-path-segment.h"
+
+namespace hadryan {
+
+// The random input of a test, from a fixed seed so every run sees the
+// same curves.
+class test_random {
+    std::mt19937 m_rng;
+public:
+    explicit test_random(unsigned seed): m_rng(seed) {}
+
+    double uniform(double a, double b) {
+        return std::uniform_real_distribution<double>(a, b)(m_rng);
+    }
+
+    // n control points from a random origin up to far pixels away,
+    // monotonic in x and y as the input pipeline leaves them, spanning
+    // up to size pixels
+    std::vector<R2> monotonic_points(int n, double size, double far) {
+        std::vector<double> xs, ys;
+        for(int i = 0; i < n; i++) {
+            xs.push_back(uniform(0, size));
+            ys.push_back(uniform(0, size));
+        }
+        std::sort(xs.begin(), xs.end());
+        std::sort(ys.begin(), ys.end());
+        if(uniform(0, 1) < 0.5) {
+            std::reverse(xs.begin(), xs.end());
+        }
+        if(uniform(0, 1) < 0.5) {
+            std::reverse(ys.begin(), ys.end());
+        }
+        R2 o = make_R2(uniform(0, far), uniform(0, far));
+        std::vector<R2> p;
+        for(int i = 0; i < n; i++) {
+            p.push_back(path_segment::off_grid(o + make_R2(xs[i], ys[i])));
+        }
+        return p;
+    }
+};
+
+} // hadryan
+
+#endif // TEST_HADRYAN_RANDOM_H
@@ -0,0 +1,127 @@
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+#include "rvg-unit-test.h"
+
+#include "hadryan-linear-path-segment.h"
+#include "hadryan-quadratic-path-segment.h"
+#include "hadryan-cubic-path-segment.h"
+#include "hadryan-segment-row.h"
+#include "hadryan-sample-lanes.h"
+#include "test-hadryan-random.h"
+
+using namespace hadryan;
+
+static test_random rnd(20);
+
+static path_segment* make_segment(int kind, double size, double far) {
+    if(kind == segment_row::linear_kind) {
+        std::vector<R2> p = rnd.monotonic_points(2, size, far);
+        return new hadryan::linear(p[0], p[1]);
+    } else if(kind == segment_row::quadratic_kind) {
+        std::vector<R2> p = rnd.monotonic_points(3, size, far);
+        double w = rnd.uniform(0, 1) < 0.5 ? 1.0 : rnd.uniform(0.25, 4);
+        return new quadratic(p[0], p[1], p[2], w);
+    }
+    std::vector<R2> p = rnd.monotonic_points(4, size, far);
+    return new cubic(p[0], p[1], p[2], p[3]);
+}
+
+// winding of one segment, and of its shortcut, at x, y
+static double reference(const path_segment &seg, bool shortcut, double x, double y) {
+    if(shortcut) {
+        return seg.intersect_shortcut(x, y) ? seg.get_sh_dir() : 0;
+    }
+    return seg.intersect(x, y) ? seg.get_dir() : 0;
+}
+
+// a sample within d of the curve along x or y, where a rounded test
+// may come out either way
+static bool near(const path_segment &seg, bool shortcut, double x, double y, double d) {
+    double r = reference(seg, shortcut, x, y);
+    return reference(seg, shortcut, x - d, y) != r || reference(seg, shortcut, x + d, y) != r
+        || reference(seg, shortcut, x, y - d) != r || reference(seg, shortcut, x, y + d) != r;
+}
+
+static const lane_kernels* kernel_sets(e_precision_mode precision, int i) {
+    const e_simd_mode modes[] = {e_simd_mode::scalar, e_simd_mode::avx2, e_simd_mode::avx512};
+    return lane_kernels::get(modes[i], precision);
+}
+
+// Every kernel set gives the winding of path_segment::intersect and
+// intersect_shortcut in double, lane by lane. In float the vector sets
+// give what the scalar one does, also from rows already in float, and
+// differ from double only next to the curve. Segments far from the
+// origin lose too much in float and are tested in double.
+static void test_kernels(void) {
+    R2 offsets[sample_lanes::max_lanes];
+    int tested = 0, rounded = 0, single = 0;
+    for(int t = 0; t < 6000; t++) {
+        int kind = t % segment_row::n_kinds;
+        bool shortcut = kind == segment_row::shortcut_kind;
+        double size = std::pow(2.0, rnd.uniform(-3, 6));
+        double far = t % 5 == 0 ? 40000 : 800;
+        std::unique_ptr<path_segment> seg(make_segment(shortcut ?
+            (t/segment_row::n_kinds) % segment_row::shortcut_kind : kind, size, far));
+        double row[segment_row::max_width];
+        if(shortcut) {
+            R2 r(seg->right());
+            row[segment_row::rx] = r[0];
+            row[segment_row::ry] = r[1];
+            row[segment_row::sh_dir] = seg->get_sh_dir();
+        } else {
+            unit_test(seg->get_row(row) == kind);
+        }
+        bool safe = lane_kernels::single_safe(kind, row, 1);
+        float single_row[segment_row::max_width];
+        std::copy(row, row + segment_row::max_width, single_row);
+        int n = 1 + t % sample_lanes::max_lanes;
+        double scale = std::min(size, 1.0);
+        for(int i = 0; i < n; i++) {
+            offsets[i] = make_R2(rnd.uniform(-0.5, 0.5)*scale, rnd.uniform(-0.5, 0.5)*scale);
+        }
+        const R2 &b0 = seg->m_bbox.get_p0();
+        const R2 &b1 = seg->m_bbox.get_p1();
+        sample_lanes lanes;
+        lanes.set(offsets, n, (float) rnd.uniform(b0[0] - 0.5, b1[0] + 0.5),
+            (float) rnd.uniform(b0[1] - 0.5, b1[1] + 0.5));
+        int32_t scalar_float[sample_lanes::max_lanes] = {};
+        kernel_sets(e_precision_mode::single, 0)->kernel[kind](row, 1, lanes, scalar_float);
+        for(int s = 0; s < 3; s++) {
+            int32_t sum[sample_lanes::max_lanes] = {};
+            const lane_kernels* k = kernel_sets(e_precision_mode::full, s);
+            unit_test(k->single[kind] == nullptr);
+            k->kernel[kind](row, 1, lanes, sum);
+            for(int i = 0; i < n; i++) {
+                unit_test(sum[i] == reference(*seg, shortcut, lanes.x[i], lanes.y[i]));
+            }
+            k = kernel_sets(e_precision_mode::single, s);
+            std::fill(sum, sum + n, 0);
+            k->kernel[kind](row, 1, lanes, sum);
+            unit_test(std::equal(sum, sum + n, scalar_float));
+            if(safe) {
+                std::fill(sum, sum + n, 0);
+                k->single[kind](single_row, 1, lanes, sum);
+                unit_test(std::equal(sum, sum + n, scalar_float));
+            }
+        }
+        for(int i = 0; i < n; i++) {
+            if(scalar_float[i] != reference(*seg, shortcut, lanes.x[i], lanes.y[i])) {
+                unit_test(near(*seg, shortcut, lanes.x[i], lanes.y[i], 1.0/64.0));
+                rounded++;
+            }
+        }
+        tested += n;
+        single += safe;
+        unit_test(safe || far > 800 || kind == segment_row::quadratic_kind
+            || kind == segment_row::cubic_kind);
+    }
+    unit_test(rounded*1000 < tested && single > 4000);
+}
+
+int main(void) {
+    test_kernels();
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <vector>
+#include <memory>
+
+#include "rvg-unit-test.h"
+
+#include "hadryan-scene-object.h"
+#include "hadryan-linear-path-segment.h"
+#include "hadryan-quadratic-path-segment.h"
+#include "hadryan-cubic-path-segment.h"
+#include "hadryan-segment-ref.h"
+#include "hadryan-segment-store.h"
+#include "hadryan-winding.h"
+
+using namespace hadryan;
+
+// a closed path with a segment of every kind, a rational quadratic
+// included, and a loop around the first one so windings reach 2
+static scene_object* make_shape(e_winding_rule wrule) {
+    std::vector<path_segment*> path;
+    path.push_back(new cubic(make_R2(10.25, 10.25), make_R2(20.5, 11.75),
+        make_R2(35.25, 22.5), make_R2(40.75, 30.25)));
+    path.push_back(new quadratic(make_R2(40.75, 30.25), make_R2(30.5, 48.25),
+        make_R2(20.25, 50.5)));
+    path.push_back(new hadryan::linear(make_R2(20.25, 50.5), make_R2(10.25, 10.25)));
+    path.push_back(new hadryan::linear(make_R2(15.5, 20.75), make_R2(30.25, 25.5)));
+    path.push_back(new quadratic(make_R2(30.25, 25.5), make_R2(28.75, 40.5),
+        make_R2(24.25, 44.75), 2.5));
+    path.push_back(new cubic(make_R2(24.25, 44.75), make_R2(19.5, 40.25),
+        make_R2(16.25, 30.5), make_R2(15.5, 20.75)));
+    return new scene_object(path, wrule, paint(RGBA8(0, 0, 0, 255), unorm8(255)));
+}
+
+// refs to every segment of obj, those in mask also as shortcuts,
+// crossing segments first as node_object keeps them
+static std::vector<segment_ref> make_refs(const scene_object &obj, unsigned mask) {
+    std::vector<segment_ref> refs;
+    for(int shortcut = 0; shortcut < 2; shortcut++) {
+        for(uint32_t i = 0; i < obj.get_path().size(); i++) {
+            if(((mask >> i) & 1) == (unsigned) shortcut) {
+                refs.push_back(make_segment_ref(i, shortcut));
+            }
+        }
+    }
+    return refs;
+}
+
+struct stored {
+    std::vector<segment_ref> refs;
+    segment_store::ranges ranges;
+};
+
+// the store of flat_tree::add_leaf, one run per mask
+static std::vector<stored> make_store(const scene_object &obj,
+    const std::vector<unsigned> &masks, segment_store &store, bool single = false) {
+    std::vector<stored> runs;
+    for(unsigned mask : masks) {
+        stored s;
+        s.refs = make_refs(obj, mask);
+        s.ranges = store.begin_ranges();
+        for(auto ref : s.refs) {
+            store.add(*obj.get_path()[segment_index(ref)]);
+        }
+        for(auto ref : s.refs) {
+            if(is_shortcut(ref)) {
+                store.add_shortcut(*obj.get_path()[segment_index(ref)]);
+            }
+        }
+        store.end_ranges(s.ranges);
+        runs.push_back(s);
+    }
+    store.finish(single);
+    return runs;
+}
+
+static const std::vector<unsigned> masks = {0, 0x3f, 0x15, 0x2a, 0x06};
+
+// the store gives winding_hit for every sample, shortcut and increment
+static void test_hit(void) {
+    for(auto wrule : {e_winding_rule::non_zero, e_winding_rule::odd}) {
+        std::unique_ptr<scene_object> obj(make_shape(wrule));
+        segment_store store;
+        std::vector<stored> runs = make_store(*obj, masks, store);
+        int tested = 0, hits = 0;
+        for(auto &run : runs) {
+            for(int increment = -1; increment <= 2; increment++) {
+                for(double y = 5.0625; y < 56; y += 0.375) {
+                    for(double x = 5.0625; x < 46; x += 0.375) {
+                        bool h = winding_hit(obj.get(), increment, run.refs.data(),
+                            run.refs.size(), x, y);
+                        unit_test(store.hit(obj.get(), increment, run.ranges, x, y) == h);
+                        tested++;
+                        hits += h;
+                    }
+                }
+            }
+        }
+        unit_test(hits > 0 && hits < tested);
+    }
+}
+
+// the same with the pattern of a pixel as lanes, for each kernel set,
+// and with the float columns for the single precision ones
+static void test_hit_lanes(void) {
+    R2 offsets[16];
+    for(int i = 0; i < 16; i++) {
+        offsets[i] = make_R2(((i%4) + 0.5)/4 - 0.5 + 0.03*(i%3),
+            ((i/4) + 0.5)/4 - 0.5 - 0.02*(i%5));
+    }
+    std::unique_ptr<scene_object> obj(make_shape(e_winding_rule::odd));
+    for(auto precision : {e_precision_mode::full, e_precision_mode::single}) {
+        bool single = precision == e_precision_mode::single;
+        segment_store store;
+        std::vector<stored> runs = make_store(*obj, masks, store, single);
+        for(auto mode : {e_simd_mode::scalar, e_simd_mode::avx2, e_simd_mode::avx512}) {
+            const lane_kernels* k = lane_kernels::get(mode, precision);
+            for(auto &run : runs) {
+                for(double y = 5.5; y < 56; y += 1.25) {
+                    for(double x = 5.5; x < 46; x += 1.25) {
+                        sample_lanes lanes;
+                        lanes.set(offsets, 16, x, y);
+                        uint64_t open = lanes.all() & 0xbfff;
+                        uint64_t h = winding_lanes(obj.get(), 1, run.refs.data(),
+                            run.refs.size(), lanes, open, *k);
+                        unit_test(store.hit_lanes(obj.get(), 1, run.ranges, lanes,
+                            open, *k) == h);
+                        for(int s = 0; s < 16 && !single; s++) {
+                            bool in = (open >> s) & 1 && winding_hit(obj.get(), 1,
+                                run.refs.data(), run.refs.size(), lanes.x[s], lanes.y[s]);
+                            unit_test(((h >> s) & 1) == in);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(void) {
+    test_hit();
+    test_hit_lanes();
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "rvg-unit-test.h"
+
+#include "hadryan-scene-object.h"
+#include "hadryan-linear-path-segment.h"
+#include "hadryan-quadratic-path-segment.h"
+#include "hadryan-cubic-path-segment.h"
+#include "hadryan-segment-ref.h"
+#include "hadryan-winding.h"
+
+using namespace hadryan;
+
+// closed polygon through points, its horizontal sides left out as they
+// never change the winding
+static void add_polygon(std::vector<path_segment*> &path, const std::vector<R2> &points) {
+    for(size_t i = 0; i < points.size(); i++) {
+        const R2 &p = points[i];
+        const R2 &q = points[(i + 1) % points.size()];
+        if(p[1] != q[1]) {
+            path.push_back(new hadryan::linear(p, q));
+        }
+    }
+}
+
+static scene_object* make_object(std::vector<path_segment*> &path, e_winding_rule wrule) {
+    return new scene_object(path, wrule, paint(RGBA8(0, 0, 0, 255), unorm8(255)));
+}
+
+// The edge cases of an analytic cover, each meeting the pixel
+// [10,11]x[15,16] with two lines.
+
+// two squares in the same direction, whose left sides cross the pixel
+// at 10.2 and 10.8, so the winding goes 0, 1, 2 across it. The first
+// side lies on the bounding box unless a third square widens it.
+static scene_object* make_overlap(e_winding_rule wrule, bool wide) {
+    std::vector<path_segment*> path;
+    if(wide) {
+        add_polygon(path, {make_R2(5.5, 12.5), make_R2(7.5, 12.5), make_R2(7.5, 14.5),
+            make_R2(5.5, 14.5)});
+    }
+    add_polygon(path, {make_R2(10.2, 12.5), make_R2(18.5, 12.5), make_R2(18.5, 19.5),
+        make_R2(10.2, 19.5)});
+    add_polygon(path, {make_R2(10.8, 13.5), make_R2(19.5, 13.5), make_R2(19.5, 18.5),
+        make_R2(10.8, 18.5)});
+    return make_object(path, wrule);
+}
+
+static scene_object* make_overlap(e_winding_rule wrule) {
+    return make_overlap(wrule, false);
+}
+
+static scene_object* make_wide_overlap(e_winding_rule wrule) {
+    return make_overlap(wrule, true);
+}
+
+// a bow tie, whose sides cross each other inside the pixel, so the
+// winding is 1 above the crossing and -1 below it
+static scene_object* make_bow_tie(e_winding_rule wrule) {
+    std::vector<path_segment*> path;
+    add_polygon(path, {make_R2(10.2, 12.5), make_R2(10.8, 18.5), make_R2(10.2, 18.5),
+        make_R2(10.8, 12.5)});
+    return make_object(path, wrule);
+}
+
+// a sliver 0.6 wide, whose opposite sides both cross the pixel
+static scene_object* make_sliver(e_winding_rule wrule) {
+    std::vector<path_segment*> path;
+    add_polygon(path, {make_R2(10.2, 12.5), make_R2(10.8, 12.5), make_R2(10.9, 18.5),
+        make_R2(10.3, 18.5)});
+    return make_object(path, wrule);
+}
+
+// a vertex inside the pixel between two sides in the same direction
+static scene_object* make_vertex(e_winding_rule wrule) {
+    std::vector<path_segment*> path;
+    add_polygon(path, {make_R2(10.2, 12.5), make_R2(16.5, 12.5), make_R2(16.5, 18.5),
+        make_R2(10.8, 18.5), make_R2(10.5, 15.5)});
+    return make_object(path, wrule);
+}
+
+// the apex of a wedge inside the pixel, between two sides in opposite
+// directions that share the rows above it
+static scene_object* make_apex(e_winding_rule wrule) {
+    std::vector<path_segment*> path;
+    add_polygon(path, {make_R2(10.5, 15.5), make_R2(10.9, 19.5), make_R2(10.1, 19.5)});
+    return make_object(path, wrule);
+}
+
+// a curved contour with a smaller one inside it in the same direction,
+// so windings reach 2 away from any edge
+static scene_object* make_curved(e_winding_rule wrule) {
+    std::vector<path_segment*> path;
+    path.push_back(new cubic(make_R2(22.25, 8.5), make_R2(30.5, 9.25),
+        make_R2(38.75, 16.5), make_R2(40.25, 28.75)));
+    path.push_back(new quadratic(make_R2(40.25, 28.75), make_R2(36.5, 44.25),
+        make_R2(24.75, 46.5), 0.6));
+    path.push_back(new hadryan::linear(make_R2(24.75, 46.5), make_R2(22.25, 8.5)));
+    path.push_back(new hadryan::linear(make_R2(28.5, 20.25), make_R2(34.75, 24.5)));
+    path.push_back(new quadratic(make_R2(34.75, 24.5), make_R2(33.25, 34.5),
+        make_R2(29.5, 38.25)));
+    path.push_back(new hadryan::linear(make_R2(29.5, 38.25), make_R2(28.5, 20.25)));
+    return make_object(path, wrule);
+}
+
+static std::vector<segment_ref> make_refs(const scene_object* obj) {
+    std::vector<segment_ref> refs;
+    for(uint32_t i = 0; i < obj->get_path().size(); i++) {
+        refs.push_back(make_segment_ref(i, false));
+    }
+    return refs;
+}
+
+// fraction of n x n samples of area that winding_hit finds inside
+static double sampled(const scene_object* obj, const std::vector<segment_ref> &refs,
+    const bouding_box &area, int n) {
+    const R2 &a0 = area.get_p0();
+    const R2 &a1 = area.get_p1();
+    int hits = 0;
+    for(int j = 0; j < n; j++) {
+        for(int i = 0; i < n; i++) {
+            hits += winding_hit(obj, 0, refs.data(), refs.size(),
+                a0[0] + (i + 0.5)*(a1[0] - a0[0])/n, a0[1] + (j + 0.5)*(a1[1] - a0[1])/n);
+        }
+    }
+    return hits/(double) (n*n);
+}
+
+static bool curve_meets(const scene_object* obj, const bouding_box &area) {
+    for(auto seg : obj->get_path()) {
+        if(seg->get_cost() > 1.0 && seg->m_bbox.intersect(area)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Two same direction sides over the same rows, and two sides crossing,
+// fail, as no single integral gives their cover. When the bounding box
+// holds back the first of the overlapping sides, the rest of the pixel
+// has one side and the cover is exact. The other edge cases give the
+// area the samples find.
+static void test_edges(void) {
+    bouding_box pixel(make_R2(10, 15), make_R2(11, 16));
+    for(auto wrule : {e_winding_rule::non_zero, e_winding_rule::odd}) {
+        double cover;
+        double expected = wrule == e_winding_rule::odd ? 0.6 : 0.8;
+        std::unique_ptr<scene_object> overlap(make_overlap(wrule));
+        std::vector<segment_ref> refs = make_refs(overlap.get());
+        unit_test(std::abs(sampled(overlap.get(), refs, pixel, 200) - expected) <= 0.01);
+        unit_test(winding_cover(overlap.get(), 0, refs.data(), refs.size(), pixel, cover));
+        unit_test(std::abs(cover - expected) <= 1e-6);
+        std::unique_ptr<scene_object> wide(make_wide_overlap(wrule));
+        refs = make_refs(wide.get());
+        unit_test(std::abs(sampled(wide.get(), refs, pixel, 200) - expected) <= 0.01);
+        unit_test(!winding_cover(wide.get(), 0, refs.data(), refs.size(), pixel, cover));
+        std::unique_ptr<scene_object> bow_tie(make_bow_tie(wrule));
+        refs = make_refs(bow_tie.get());
+        unit_test(!winding_cover(bow_tie.get(), 0, refs.data(), refs.size(), pixel, cover));
+        for(auto make : {make_sliver, make_vertex, make_apex}) {
+            std::unique_ptr<scene_object> obj(make(wrule));
+            refs = make_refs(obj.get());
+            unit_test(winding_cover(obj.get(), 0, refs.data(), refs.size(), pixel, cover));
+            unit_test(cover > 0 && cover < 1);
+            unit_test(std::abs(cover - sampled(obj.get(), refs, pixel, 128)) <= 0.02);
+        }
+    }
+}
+
+// Over every pixel of every shape, winding_cover either fails or gives
+// the area the samples find, up to the error of 128 x 128 of them.
+// Curves whose bounding box only touches a pixel leave it exact.
+static void test_cover(void) {
+    for(auto wrule : {e_winding_rule::non_zero, e_winding_rule::odd}) {
+        int exact = 0, partial = 0, failed = 0, touched = 0;
+        for(auto make : {make_overlap, make_wide_overlap, make_bow_tie, make_sliver,
+            make_vertex, make_apex, make_curved}) {
+            std::unique_ptr<scene_object> obj(make(wrule));
+            std::vector<segment_ref> refs = make_refs(obj.get());
+            const R2 &b0 = obj->get_bbox().get_p0();
+            const R2 &b1 = obj->get_bbox().get_p1();
+            for(int y = (int) b0[1] - 1; y <= (int) b1[1] + 1; y++) {
+                for(int x = (int) b0[0] - 1; x <= (int) b1[0] + 1; x++) {
+                    bouding_box pixel(make_R2(x, y), make_R2(x + 1, y + 1));
+                    double cover;
+                    if(!winding_cover(obj.get(), 0, refs.data(), refs.size(), pixel,
+                        cover)) {
+                        failed++;
+                        continue;
+                    }
+                    unit_test(std::abs(cover - sampled(obj.get(), refs, pixel, 128)) <= 0.02);
+                    exact++;
+                    partial += cover > 0 && cover < 1;
+                    touched += curve_meets(obj.get(), pixel);
+                }
+            }
+        }
+        unit_test(partial > 0 && failed > 0 && touched > 50 && exact > 10*failed);
+    }
+}
+
+int main(void) {
+    test_edges();
+    test_cover();
+    return 0;
+}
@@ -8,15 +8,10 @@ dy=1
 in=$1
 mkdir ../video-data
 mkdir ../videos-out
-i=0
-for ((x=$xi; x<=$xf; x+=$dx)) do
-	luapp5.3 process.lua driver.hadryan_salles ../rvgs/$in.rvg ../video-data/$in-`printf %05d $i`.png -tx:$x $@ 
-	((i++))
-done
-for ((y=$yi; y<=$yf; y+=$dy)) do
-	luapp5.3 process.lua driver.hadryan_salles ../rvgs/$in.rvg ../video-data/$in-`printf %05d $i`.png -ty:$y $@ 
-	((i++))
-done
+# every frame is rendered by a single process from a single scene load
+nx=$(( (xf-xi)/dx+1 ))
+ny=$(( (yf-yi)/dy+1 ))
+luapp5.3 animate.lua driver.hadryan_salles ../rvgs/$in.rvg ../video-data/$in-%05d.png -sweep:$xi:0:$xf:0:$nx -sweep:0:$yi:0:$yf:$ny $@
 ffmpeg -framerate 60 -i ../video-data/$in-%05d.png -y ../videos-out/$in.mp4
 open ../videos-out/$in.mp4
 #rm -rf ../video-data